@@ -1,4 +1,20 @@
+#define _GNU_SOURCE  /* for memfd_create */
 #include <stdio.h> 
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 /*
   cycle_detector - detects links that would create cycles in directed graphs of
@@ -39,6 +55,33 @@
   would create a cycle, so reject the link. Otherwise, update the matrix so that
   node i and all its ancestors are ancestors of node j and its descendants. 
 
+  Command line options:
+
+   -d  deferred propagation; see Deferred Propagation below.
+   -b  batch mode; see Batches below.
+   -a  atomic batch mode; see Batches below.
+   -e engine  "matrix" (the default), "bloom" or "italiano"; see Engines below.
+   -k hashes  bits set per ancestor by the bloom engine (1 to BLOOM_HASHES).
+   -w fields  FIELDs per row used by the bloom engine (1 to BLOOM_FIELDS).
+   -s  keep reachability sketches; see Sketches below.
+   -v count  keep the last count versions of the matrix; see Versions below.
+   -n  nodes are named by strings rather than numbers; see Names below.
+   -H path  listen on Unix socket path for a successor; see Handover below.
+   -T path  take over from the process listening on path; see Handover below.
+   -p  pipelined line mode on three threads; see Pipeline below.
+   -o path  record accepted links in a link log; see Link Logs below.
+   -r path  replay a link log before reading input; see Link Logs below.
+   -f path  read the links in a text file or link log before reading input;
+       see Ingestion below.
+   -m megabytes  keep at most this much of the matrix unpacked; see Memory
+       Budget below.
+   -A allocator  "slab" (the default) or "huge"; see Allocators below.
+   -q  line mode through the async requests; see Async Requests below.
+   -E  keep the accepted links for export; see Exports below.
+   -c  condensation: merge the nodes of a cycle instead of rejecting the
+       link; see Condensation below.
+   -L  keep the depth level of every node; see Levels below.
+
 	This solution does not preserve any information about the actual links in the
 	graph. For example, there is no change to the ancestors matrix when a link
 	1->3 is added to an ancestors matrix that already contains links for
@@ -78,6 +121,13 @@
 	containing the value will be the n % FIELD_SIZE bit. Bit twiddling is
 	localized in the functions is_ancestor and set_ancestor and the single OR in
 	insert_ancestors. 
+
+	The self-links are implicit rather than stored. is_ancestor(n,n) is TRUE
+	without looking at the matrix, and or_row adds the source node itself along
+	with the source row, so row i never holds its own bit. A fresh
+	cycle_detector therefore writes nothing to the matrix at startup. Rows of
+	nodes that never take part in a link are never touched and cost no
+	memory.
  
   Complexity
  
@@ -99,6 +149,530 @@
   simultaneously, so that on 64 bit hardware, the OR's would require
   10^10 operations instead of 10^16.
 	
+  Deferred Propagation
+
+  With -d, insert_link_deferred decides PASS or FAIL immediately and leaves the
+  O(CN) row update for later. Accepted links wait in the pending array (the
+  "overlay") until propagate_pending has visited every row on their behalf.
+  The main loop calls propagate_pending in slices of SLICE_ROWS rows whenever
+  no input is waiting, so the work happens while the program would otherwise
+  sit idle.
+
+  Queries stay exact while links are pending. The ancestors matrix only ever
+  holds true relationships, so is_reachable answers "is a an ancestor of n"
+  by searching for a chain a ~> s1->e1 ~> s2->e2 ... ~> n, where each ~> is a
+  single ancestors lookup and each s->e is a pending link. That costs at most
+  O(P^2) lookups for P pending links and usually far fewer.
+
+  propagate_pending applies pending links in generations. When a generation
+  starts it brings the rows of its start nodes up to date by running the
+  ordinary algorithm on those few rows only. Those rows are then exact, so one
+  sweep over all rows can apply every link of the generation at once: row k
+  is ORed with row s for each link s->e of the generation where e is already
+  an ancestor of k. Links accepted during the sweep join the next generation.
+  When the overlay is full (PENDING_LINKS), or a synchronous insert_link
+  arrives, the remaining work is drained before continuing.
+
+  Components
+
+  A link can only close a cycle between nodes that are already connected,
+  ignoring direction. The nodes are therefore kept in weakly connected
+  components with union-find (find_component and join_components). Each
+  component also keeps its members on a circular list threaded through
+  component_next, and the lowest and highest member number. When i and j are in
+  different components the insert cannot fail and needs no ancestors
+  lookup. The descendants of j all lie in j's component, so insert_ancestors
+  walks that member list instead of all TOTAL_NODES rows. The ancestors of i
+  all lie between the lowest and highest members of i's component, so or_row
+  only ORs the FIELDs covering that range. For a graph made of many small
+  components, an insert costs in proportion to the size of j's component
+  rather than N.
+
+  Batches
+
+  insert_links_greedy accepts as many links of a batch as it can, highest
+  priority first (ties in batch order). Each link is checked against the
+  links already accepted and rejected if it would close a cycle, exactly as
+  if the links had been passed one at a time to insert_link in that order.
+  The accepted links go through the pending overlay, so the rows are updated
+  by a few generation sweeps rather than one sweep per link.
+
+  With -b, lines of the form "start end [priority]" are collected until a
+  blank line or end of input. The batch is then submitted and one result is
+  printed for each line, in input order. The priority defaults to 0.
+
+  insert_links_atomic accepts all links of a batch or none of them. Each link
+  is checked in turn with overlay_reachable, whose overlay is the pending
+  links followed by the batch links checked so far, so a cycle closed by the
+  batch as a whole is found without touching the matrix. Only when every
+  link passes are the links committed to the overlay and applied in a single
+  generation sweep. With -a, each blank-line separated batch is submitted
+  this way and a single result is printed for it.
+
+  Statistics
+
+  or_row knows exactly which bits each union adds to a row, so the closure
+  statistics are kept up to date from those deltas and never need a rescan
+  of the matrix. ancestor_count[k] and descendant_count[k] count the
+  ancestors and descendants of node k, not counting k itself, and
+  reachable_pairs is their common total. The largest counts and the
+  TOP_NODES most connected nodes (ancestors plus descendants) are updated as
+  the counts rise. Counts only grow, so an update only has to compare the
+  node that changed against the list. get_closure_stats fills in a
+  closure_stats in O(TOP_NODES). Lines starting with "." are commands: the
+  ".stats" command prints them.
+
+  or_row works in blocks of BLOCK_BYTES, one cache line. It first tests
+  whether any FIELD of the source block has a bit the destination lacks, and
+  stores the block only if it does. Rows that gain nothing are never written.
+  Their cache lines stay clean, and pages still shared with the zero page, or
+  with another process, are not copied. or_row returns the number of blocks
+  it wrote. The totals are reported by ".stats".
+
+  Engines
+
+  The ancestors relation is kept by an engine: a struct engine holding an
+  is_ancestor and an insert_ancestors function. insert_link and the batch
+  functions call the selected engine. The component checks above apply to
+  every engine. The matrix engine is the exact bit matrix described above.
+  Deferred propagation and block writes belong to the matrix. With another
+  engine, deferred inserts are applied at once.
+
+  The bloom engine is approximate and fixed in size. Row i of bloom_rows is a
+  blocked Bloom filter of the ancestors of i. Each ancestor is hashed to one
+  FIELD of the row and sets bloom_hashes bits within it. insert_ancestors is
+  the matrix algorithm with the filters in place of rows: the filter of every
+  node whose filter matches j gets the filter of i ORed in, plus i itself.
+  A filter never forgets an ancestor, so every real cycle is found. A false
+  match can only add ancestors, which means an occasional link is rejected
+  with "Cycle found" even though it closes no cycle. The whole engine takes
+  TOTAL_NODES * BLOOM_FIELDS FIELDs, 4 MB, whatever the graph. The false
+  positive rate for a row holding n ancestors in m = bloom_fields * FIELD_SIZE
+  bits is roughly (1 - e^(-kn/m))^k for k = bloom_hashes. More FIELDs lower
+  it. The best k is about (m/n) ln 2. ".stats" reports the rate estimated
+  from the current filters, averaged over linked nodes.
+
+  The italiano engine follows G. F. Italiano, "Amortized efficiency of a
+  path retrieval data structure" (1986). Every node x has a reachability
+  tree T(x): a spanning tree of its descendants, rooted at x, stored in a
+  hash table (struct reach_tree) that maps each descendant to its parent and
+  children in the tree. A cycle check looks n up in T(a), in O(1). To insert
+  i->j, the engine visits every x that has i but not j in its tree and melds
+  T(j) into T(x) below i. The meld walks T(j) from the top and stops at any
+  node T(x) already holds, since that node's whole subtree is then already
+  there. Each (x, descendant) pair is therefore visited once over the life of
+  the graph. That is O(N^2) in total, O(N) amortized per insert, however
+  many rows a matrix union would have touched. The x to visit come from
+  ancestor_lists, the reverse index of the trees. Memory grows with the
+  number of reachable pairs, about 32 bytes each, instead of the fixed N^2
+  bits of the matrix. The statistics are kept from the pairs as they are
+  added.
+
+  Sketches
+
+  With -s, every node gets two HyperLogLog sketches, one of its ancestors
+  and one of its descendants. They give approximate counts under any engine,
+  including those that keep no full rows. A sketch is HLL_REGISTERS 4 bit
+  registers packed into SKETCH_FIELDS FIELDs, 512 bytes, allocated when the
+  node is first linked. The standard error is 1.04/sqrt(HLL_REGISTERS),
+  about 3%.
+
+  sketch_link runs after a link i->j has been applied. It takes the same walk
+  as insert_ancestors: every k in j's component with j as an ancestor gets
+  i's ancestor sketch merged into its own, plus i. Every a in i's component
+  that is an ancestor of i gets j's descendant sketch, plus j. Merging is a
+  register-wise maximum, done a FIELD at a time on packed registers by
+  merge_sketch. Deferred links are sketched when their generation
+  completes. The ".count n" command prints the estimates for node n.
+
+  Versions
+
+  With -v, every accepted insert_link, and every completed generation of
+  deferred links, makes a new immutable version of the matrix. Versions are
+  numbered from 0, the empty graph, and stamped with the time they were
+  made. is_ancestor_at and insert_link_at answer queries against any version
+  still kept, for example whether a link would have been accepted at a given
+  time. Only the last versions_kept versions are kept. Older ones are
+  released as new ones are made.
+
+  A version is a hash array mapped trie over the matrix cut into leaves of
+  VERSION_LEAF_FIELDS FIELDs. Each trie node has a 32 bit bitmap of the
+  children present and an array holding only those children. Leaves that
+  are all zero are absent. or_row records every leaf it writes in
+  dirty_leaves. A new version copies just those leaves from the matrix, and
+  copies the trie nodes on their paths. Every other node and leaf is shared,
+  with a reference count, with the version before it. A version therefore
+  costs the leaves that changed since the last one plus their paths. The
+  ".versions", ".at version start end" and ".asof time start end" commands
+  list the versions and query them. The time is in seconds since the epoch.
+  Versions need the matrix engine. With -d a version is made each time a
+  generation of pending links is applied, so one version may add several
+  links. The commands drain the pending links first, like the other queries.
+
+  Names
+
+  With -n, each input line is "start end" where start and end are names,
+  such as job or package ids, made of any characters but white space. A
+  name must not start with "." since that marks a command. intern_node gives
+  each distinct name a node number, in order of first appearance, until
+  TOTAL_NODES names are in use. insert_link_named interns both names and
+  calls the usual insert.
+
+  The symbol table is built for throughput. Names are copied once into
+  symbol_arena and never move or get freed. symbol_slots is an open
+  addressing table with linear probing and twice as many slots as nodes, so
+  probe runs stay short. Each slot holds the full 32 bit hash as well as the
+  node number. A probe compares the hash and length first and only then the
+  bytes, so a lookup usually costs one hash and one memcmp. hash_name reads
+  the name a FIELD at a time.
+
+  Handover
+
+  A new cycle_detector binary can replace a running one without rebuilding
+  the graph. The running process is started with -H path. It listens on the
+  Unix socket at path while it waits for input. The new process is started
+  with -T path (and -H path, to be replaceable in turn). It connects, and
+  the old process passes it three file descriptors with SCM_RIGHTS: the
+  matrix, its standard input, and a memfd holding the rest of the state.
+  The matrix lives in a memfd whenever -H is given, so it is shared rather
+  than copied. The state is every array in state_sections: components,
+  statistics, the pending overlay with any generation in progress, the
+  bloom filters, the names, and the input read but not yet processed. It
+  comes to about 13 MB, written in a few milliseconds. Once the new process
+  has mapped everything it acknowledges with one byte, and the old process
+  exits. Until then the old process keeps serving, so a failed takeover
+  costs nothing. The new process reads the rest of the old input from
+  where the old one stopped, at a line boundary. Handover works on Linux
+  only, in line mode, with the matrix or bloom engine, and without -s or
+  -v, whose state is not carried over.
+
+  Input is read through input_buffer rather than stdio, so the program can
+  tell whether a whole line is already waiting. wait_for_input blocks in
+  poll on standard input and the handover socket. When deferred links are
+  pending it does not block but runs propagate_pending between polls.
+
+  Pipeline
+
+  With -p the line mode runs as three stages on their own threads. The
+  main thread parses lines into batches of up to BATCH_LINKS links. The
+  engine thread checks and inserts them, and the formatter thread prints
+  the results. Batches are passed by index through three single-producer
+  single-consumer rings: parsed_ring to the engine, checked_ring to the
+  formatter, and free_ring back to the parser. There are as many batches
+  as ring slots, so a push never finds its ring full. A stage with nothing
+  to do spins briefly and then sleeps in RING_SPINS steps, except that an
+  idle engine runs deferred propagation. The parser sends a partial batch
+  whenever no whole line is waiting, so interactive use sees no delay.
+
+  The output is the same as without -p. Dot-commands go to the engine in
+  a batch of their own and run once everything before them is printed,
+  and the parser waits for them, so commands always see a quiet pipeline.
+  Names are interned by the parser, which is the only thread that touches
+  the symbol table outside commands. The parser also catches the links
+  check_link would reject, and the formatter calls check_link to print
+  the complaint in its place.
+
+  Parsing
+
+  Link lines are read with parse_pair rather than sscanf. It loads eight
+  bytes of the line into a word, and finds the leading digits of all
+  eight at once: a byte is a digit when its value XOR '0' is below 10,
+  which one addition per word tests for every byte (SWAR, SIMD within a
+  register). The digit bytes are then turned into a number with three
+  multiplications, whatever their count, and without branches. Lines that
+  are not two runs of 1 to 7 digits split by spaces, such as negative
+  numbers or tabs, go to sscanf, so the accepted input is unchanged.
+  Malformed lines are reported with their line number, input_line. A
+  line longer than LINE_BYTES - 1 characters is skipped whole, with one
+  complaint, so no part of it is ever read as a link.
+
+  Link Logs
+
+  A link log is a binary archive of accepted links, much smaller and
+  faster to load than the text they came from. With -o path every link
+  that is accepted is recorded, so running
+
+    cycle_detector -o history.log < history.txt > /dev/null
+
+  converts a text history. With -r path the log is replayed before any
+  input is read, which restores the graph, and the program then carries
+  on as usual.
+
+  The log holds blocks of up to LOG_BLOCK_LINKS links. The links of a
+  block are sorted by start and then end, and stored as varints (7 bits
+  a byte, the high bit meaning "more"). Each start is stored as its
+  difference from the previous start, and each end as its difference
+  from the previous end under the same start, or in full. Most links thus
+  take 2 to 4 bytes instead of the 12 or so of a text line. Sorting is
+  safe because only accepted links are logged: together they form no
+  cycle, so they are all accepted again in any order.
+
+  The file begins with "CDLG" and a version. Each block has a header of
+  its link count, its payload size and a CRC-32 of the payload. An index
+  after the last block gives the offset, link count and first start node
+  of every block, for seeking. A trailer gives the index offset, the
+  block count and "CDIX". All numbers are little-endian.
+
+  Replay maps the file and decodes blocks on up to REPLAY_THREADS threads,
+  which take blocks in order. The main thread inserts each block as a
+  batch, as -b does, once it is decoded, so decoding overlaps insertion.
+  A block that fails its checksum is reported and skipped. Replayed links
+  are not logged again. Names are not logged, and -o and -r are not
+  carried over by a handover, so both refuse -n, -H and -T.
+
+  Ingestion
+
+  With -f path a file of links is read before standard input, much as if
+  it came first on standard input, but without copying it through read.
+  Results are printed as in -b, without prompts. A link log given to -f
+  is replayed as by -r.
+
+  The file is mapped with MADV_SEQUENTIAL and cut into slices of
+  INGEST_SLICE_BYTES. Up to INGEST_THREADS threads parse slices straight
+  from the mapping with scan_pair, falling back to sscanf on a copy of odd
+  lines. A slice starts after the first newline at or after its nominal
+  start, and ends where the next one starts, so no line is split. The
+  main thread inserts the parsed slices in order, since the order of the
+  links decides which are accepted. Parsers stay at most INGEST_WINDOW
+  slices ahead, each with a buffer of its own. Once a slice is inserted,
+  its pages are released with MADV_DONTNEED, and so are the blocks of a
+  replayed log, so the resident size does not grow with the file. Dot
+  commands in the file are run in order, by the main thread.
+
+  Memory Budget
+
+  The matrix takes 8 KB per row once a row is written, 512 MB when every
+  node is linked. With -m megabytes only that much of it stays as plain
+  rows, and colder rows are packed. Every row access goes through row_of
+  (writable_row for writes), which unpacks a packed row first. Rows that
+  hold bits are kept in clock_rows, a clock: an access sets the row's
+  referenced flag. When there are more rows than the budget allows,
+  enforce_row_budget moves the hand along clock_rows. A referenced row
+  loses its flag and is passed over; an unreferenced one is packed. The
+  two rows last returned by row_of are never packed, since or_row works
+  on two rows at once.
+
+  is_ancestor reads a bit of a packed row by binary search, without
+  unpacking it, so the sweeps of deferred propagation do not churn the
+  clock. Only writes and whole-row reads unpack.
+
+  A packed row is stored in one of two forms, whichever is smaller: the
+  positions of its bits (2 bytes each), or its runs of bits as start and
+  length pairs (4 bytes each). Rows of a connected graph tend to hold long
+  runs, since components take consecutive numbers where they can. A row
+  neither form shrinks is left unpacked. The pages of a packed row are
+  given back to the system with madvise. The .stats command reports how
+  many rows are packed, their size, and how many row accesses found the
+  row packed, the hit rate that shows what the budget costs. A handover
+  unpacks every row first, since packed rows are not in the matrix memfd.
+  A successor given -m counts the rows it inherits as they are written.
+  The budget applies to the matrix engine.
+
+  Set Queries
+
+  Some questions are about sets of nodes rather than pairs. A node set is
+  a bitmap the size of a row, and the rows are node sets already: row n,
+  plus n itself, is the set of n's ancestors (ancestor_set). So
+
+    common_ancestors      ANDs the ancestor sets of some nodes,
+    any_ancestors         ORs them, and
+    subtract_ancestors    clears (ANDNOT) them from a set.
+
+  Each is a loop over FIELDs, FIELDS_PER_NODE per row, that the compiler
+  can vectorise. The nodes reachable from any of a set S are a column of
+  the matrix rather than a row. reachable_from tests the rows in the
+  components of S against a mask of S, one FIELD at a time within the
+  component bounds. next_in_set streams the members of a set in order.
+  With other exact engines the sets are built from engine->is_ancestor
+  over the component, a pair at a time. The bloom engine is approximate
+  and has no set queries.
+
+  The commands are ".common n ...", ".ancestors n ..." and ".reach n ...".
+  Each prints the size and members of the set, and each takes "- m ..."
+  after its nodes to leave out the ancestors of m (or what m reaches, for
+  .reach).
+
+  Rank and Select
+
+  To page through the ancestors of a node, row_rank counts the ancestors
+  numbered below a bound, row_range_count those in a range, and
+  row_select finds the k-th, all without scanning the row. Each uses the
+  rank directory of the row. The directory is the number of ancestors
+  before each RANK_BLOCK_BITS (512 bit) block, RANK_BLOCKS unsigned shorts
+  or 256 bytes a row. A rank is then one directory entry plus at most 8
+  FIELD popcounts. A select is a binary search over the directory plus at
+  most 8 FIELDs. Directories are made on first use. or_row marks a row's
+  directory stale whenever it writes the row, and it is rebuilt when next
+  used. Rows that are never queried cost nothing. The ancestors of a node
+  here exclude the node itself, as in .count.
+
+  The commands are ".rank n low high", the number of ancestors of n from
+  low to less than high, and ".select n k", the k-th ancestor of n in
+  increasing order, from 0. They need the matrix engine.
+
+  Allocators
+
+  The matrix, packed rows, rank directories, sketches, version leaves, and
+  the trees and ancestor lists of the italiano engine are allocated
+  through allocator, a struct allocator of two functions:
+
+    allocate(size, alignment, numa_node)   zeroed memory, or NULL
+    release(memory, size)                  with the size it was allocated
+
+  alignment is a power of 2 no larger than PAGE_BYTES. numa_node is a hint
+  for allocators that place memory, ANY_NUMA_NODE for no preference; the
+  program always passes ANY_NUMA_NODE and the allocators here ignore it.
+  Allocation happens on one thread at a time, so an allocator need not
+  lock. A program embedding cycle_detector sets allocator to its own
+  before initialize_matrix, for a hugepage pool or a pre-faulted arena.
+
+  The default, "slab", keeps a free list for each power of 2 size from
+  SLAB_MIN_BYTES to SLAB_MAX_BYTES, carved from SLAB_CHUNK_BYTES chunks
+  that are mapped as needed and never returned. Rows and their parts come
+  in a few fixed sizes, so the lists are reused with no per-block header
+  and little fragmentation. A block is aligned to its size, up to a page,
+  so an alignment is met by the size class. Larger requests, the matrix
+  among them, are mapped and unmapped directly. The "huge" allocator maps
+  requests of HUGE_PAGE_BYTES or more on a huge page boundary and asks for
+  transparent huge pages, and leaves the rest to slab. With -H or -T the
+  matrix is always in a memfd, whatever the allocator.
+
+  Async Requests
+
+  A program with an event loop cannot wait for insert_ancestors. It can
+  instead call start_async, which starts an executor thread, and then
+
+    async_insert(start, end, callback, context)
+    async_query(node, ancestor, callback, context)
+
+  Each returns the answer at once when it can, FAIL for a link whose end is
+  already an ancestor of its start, TRUE for a query that finds the bit,
+  BAD_DATA for nodes out of bounds, without calling callback. Otherwise
+  the request is queued and ASYNC_PENDING is returned, or ASYNC_BUSY if
+  ASYNC_SLOTS requests are waiting to be dispatched. The quick answers
+  read the matrix while the executor writes it, a FIELD at a time with a
+  relaxed atomic load, and or_row stores each FIELD with a relaxed atomic
+  store, so the two never race. A quick answer may miss a bit that is
+  being set, and then the request is queued. It never sees a wrong bit,
+  since bits are only ever set. It needs the matrix engine and no -m or
+  -c, since other engines and packed rows keep ancestors elsewhere and -c
+  clears bits.
+
+  The executor takes every request queued since its last pass and runs
+  them in one pass, in order, so requests from many callers share a pass.
+  The links go through the deferred overlay, answered by
+  insert_link_deferred, and drain_pending then applies all of them in one
+  sweep over the rows, instead of one insert_ancestors each. Under -c the
+  links are inserted one at a time, since the overlay cannot merge cycles.
+  So -d makes no difference to -q. The executor then writes a byte to a
+  pipe. The event loop watches async_fd and calls dispatch_async when it
+  is readable, which runs the callbacks of finished requests on the loop's
+  own thread, one thread only. stop_async finishes the queue and stops the
+  executor. Nothing else may touch the graph while the executor runs.
+
+  With -q the line mode uses these requests. The main thread parses lines
+  and submits links, and prints the answers in input order as they come
+  back, so the output is the same as without -q. Dot-commands run on the
+  executor once every earlier answer is printed.
+
+  Exports
+
+  The command ".export what format path" writes the graph out in bulk, to
+  the file path, or to the standard input of a command given as "|command".
+  what is one of
+
+    closure    every non-empty row, node by node,
+    order      the linked nodes in a topological order, and
+    reduction  the transitive reduction, the fewest links with the same
+               closure,
+
+  and format is "csv" or "binary". Each is streamed through stdio as it is
+  computed, so beyond the stdio buffer an export needs at most one row of
+  scratch, plus two arrays of TOTAL_NODES ints for the order. Under -m a
+  closure export reads the rows the budget keeps packed as they are, so
+  it neither unpacks them nor disturbs the clock.
+
+  In binary, a closure row is its node (2 bytes), a format (1 byte), a
+  count (2 bytes) and the items. The format and items are those of a
+  packed row, PACKED_BITS or PACKED_RUNS (see Memory Budget), 2 bytes an
+  item, or EXPORT_RAW and the row itself as FIELDS_PER_NODE 8-byte words
+  when neither is smaller. In CSV a row is a line "node,first,last" for
+  each run of ancestors. A binary order is the nodes, 2 bytes each, and a
+  binary reduction is start and end pairs, 2 bytes each. Binary exports
+  begin with a 4-byte magic number and a 4-byte version, and numbers are
+  little-endian like link logs. CSV files begin with a header line.
+
+  The order needs no search. A proper ancestor u of v has fewer
+  ancestors than v, since the ancestors of v include u and all of u's.
+  So sorting the nodes by ancestor_count, a counting sort, gives a
+  topological order. Nodes with the same count are in node order.
+
+  The reduction needs the links themselves. The matrix does not keep
+  them, so -E keeps every accepted link in out_edges, a list of end
+  nodes for each start node, allocated like the engines' edge storage
+  (see Allocators). A stored link u->v belongs to the reduction unless
+  another link u->w leads to v, that is unless w is an ancestor of v. The
+  exporter sorts each list and drops repeats in place, and then tests
+  each pair with is_ancestor. Exports need the matrix engine, and -E does
+  not survive a handover.
+
+  Condensation
+
+  With -c a link that would close a cycle is accepted, and the nodes on
+  the cycle become one strong component, reported as "Cycle merged". The
+  matrix then holds the condensed graph: each strong component is one
+  node, its representative, and only representatives have rows or appear
+  as bits. Strong components are kept like the weak ones of Components,
+  by union-find (strong_parent, with strong_next listing the members of
+  each), and insert_link maps both ends of a link to their
+  representatives before anything else. A link within one component
+  changes nothing.
+
+  When start->end closes a cycle, end already reaches start, and the
+  nodes to merge are start and those of its ancestors that end reaches.
+  merge_strong_components folds them into end. Every row outside the
+  merged set that holds end's bit is a descendant. Each such row takes
+  start's row with or_row, as for an ordinary link, and then drops the
+  merged bits with forget_ancestors. The row of end does the same. The
+  rows of the other merged nodes are cleared, and their pages are given
+  back, so the matrix shrinks as the graph collapses. forget_ancestors
+  lowers the counts of Statistics. Counts can then fall, so the largest
+  counts and top_nodes are rebuilt by a scan of the nodes after each
+  merge. .stats reports how many nodes were folded into how many
+  components. ".component n" lists the component of n.
+
+  Commands that read rows answer for representatives. A member other
+  than the representative has no row, and no bits. Condensation needs
+  the matrix engine in line mode, and no -d, -s, -v, -m, -o, -r, -f or
+  -E, whose links and rows assume an acyclic graph.
+
+  Levels
+
+  With -L every node has a level, the length of the longest chain of
+  links leading to it: 0 for a node no link leads to, and otherwise one
+  more than the highest level among the starts of its links. The level
+  of the deepest node is the critical path of the graph. Levels need the
+  links, so -L keeps them as -E does, and keep_edge raises the levels
+  after each accepted link. raise_levels lifts the end of the link above
+  its start if it is not already, then follows out_edges from each node
+  it lifts, and stops where a node is already high enough. Only nodes
+  whose level rises are touched, and a level is read from node_level in
+  O(1). ".level n" prints the level of n, and .stats the deepest level
+  and the work done.
+
+  A link only ever leads to a higher level, so an ancestor of v always
+  has a lower level than v. is_ancestor, bloom_is_ancestor and
+  italiano_is_ancestor answer FALSE without looking further when the
+  supposed ancestor is not lower. That saves a row or hash lookup in the
+  loops over a component, and stops the Bloom engine's false positives
+  from ever crossing levels. overlay_reachable does not search on from a
+  pending link whose end is not lower than the node sought. Levels count
+  pending links as soon as they are accepted. That makes them a little
+  higher than the matrix alone would give, which is still a valid bound.
+  The batch links an atomic batch is only trying out have no levels yet,
+  so overlay_reachable prunes only when no such links are in play.
+  Levels assume an acyclic graph and are not kept with -c.
+
   Data Structures
   
   ancestors - N x N matrix of bits that represents links that if inserted, will
@@ -130,118 +704,4644 @@
 #define FIELD_SIZE      (sizeof(FIELD)*8)
 #define FIELDS_PER_NODE (TOTAL_NODES/FIELD_SIZE)
 
-/* Declare ancestors matrix */
+#define BLOCK_BYTES     64  /* unit written by or_row, one cache line */
+#define BLOCK_FIELDS    (BLOCK_BYTES/sizeof(FIELD))
+
+/* Declare ancestors matrix, mapped by initialize_matrix */
+
+FIELD (*ancestors)[FIELDS_PER_NODE];
+int matrix_fd = -1;  /* memfd behind the matrix, with -H or -T */
+
+/* Memory budget, see above */
+
+#define ROW_BYTES (FIELDS_PER_NODE * sizeof(FIELD))
+
+#define ROW_UNTOUCHED 0        /* row_state values */
+#define ROW_UNPACKED 1
+#define ROW_PACKED 2
+
+#define PACKED_BITS 0          /* packed_row formats */
+#define PACKED_RUNS 1
+
+struct packed_row {
+	int format;
+	int n_items;                 /* bit positions, or start and length - 1 pairs */
+	unsigned short items[];
+};
+
+int budget_rows = 0;           /* -m, in rows; 0 for no budget */
+unsigned char row_state[TOTAL_NODES];
+unsigned char row_referenced[TOTAL_NODES];
+struct packed_row *packed_rows[TOTAL_NODES];
+int clock_rows[TOTAL_NODES];   /* the ROW_UNPACKED rows */
+int clock_slot[TOTAL_NODES];   /* where each is in clock_rows */
+int n_clock_rows = 0, clock_hand = 0;
+int last_rows[2] = { -1, -1 };
+int n_packed_rows = 0;
+long packed_bytes = 0, row_accesses = 0, packed_hits = 0;
+
+/* Rank directories, see Rank and Select above */
+
+#define RANK_BLOCK_BITS 512
+#define RANK_BLOCK_FIELDS (RANK_BLOCK_BITS / FIELD_SIZE)
+#define RANK_BLOCKS (TOTAL_NODES / RANK_BLOCK_BITS)
+
+unsigned short *rank_directories[TOTAL_NODES];  /* allocated on first use */
+unsigned char rank_valid[TOTAL_NODES];
+
+/* Weakly connected components, see Components above */
+
+unsigned short component_parent[TOTAL_NODES];  /* union-find forest */
+unsigned short component_next[TOTAL_NODES];    /* circular member list */
+unsigned short component_low[TOTAL_NODES];     /* lowest member, at roots */
+unsigned short component_high[TOTAL_NODES];    /* highest member, at roots */
+int component_size[TOTAL_NODES];               /* member count, at roots */
+
+/* Closure statistics, see Statistics above */
+
+#define TOP_NODES 10
+
+struct closure_stats {
+	long reachable_pairs;     /* (ancestor, descendant) pairs, self excluded */
+	int linked_nodes;         /* nodes in at least one accepted link */
+	double average_ancestors; /* per linked node */
+	double average_descendants;
+	int max_ancestors;
+	int max_ancestors_node;
+	int max_descendants;
+	int max_descendants_node;
+	int n_top;                /* entries used in top_nodes */
+	int top_nodes[TOP_NODES]; /* most connected first */
+	int top_connections[TOP_NODES];
+	long row_unions;          /* calls to or_row */
+	long blocks_tested;       /* blocks or_row compared */
+	long blocks_written;      /* blocks that gained bits and were stored */
+};
+
+int ancestor_count[TOTAL_NODES];
+int descendant_count[TOTAL_NODES];
+long reachable_pairs = 0;
+int linked_nodes = 0;
+int max_ancestors = 0, max_ancestors_node = 0;
+int max_descendants = 0, max_descendants_node = 0;
+int top_nodes[TOP_NODES];  /* most connected first */
+int n_top = 0;
+unsigned char in_top[TOTAL_NODES];
+long row_unions = 0, blocks_tested = 0, blocks_written = 0;
+
+/* Deferred propagation: links accepted but not yet applied to every row */
+
+#define PENDING_LINKS 1024  /* capacity of the pending overlay */
+#define SLICE_ROWS    4096  /* rows visited per background time slice */
+
+struct link {
+	int start;
+	int end;
+};
+
+/* A link proposed as part of a batch, with the result it received */
+
+struct batch_link {
+	int start;
+	int end;
+	int priority;  /* higher priorities are considered first */
+	int result;    /* PASS, FAIL or BAD_DATA */
+};
+
+struct link pending[PENDING_LINKS];
+int n_pending = 0;    /* links in the overlay */
+int n_sweeping = 0;   /* leading links of pending[] in the current generation */
+int sweep_row = 0;    /* next row to visit in the current generation */
+int sweep_roots[PENDING_LINKS]; /* components the current generation walks */
+int n_sweep_roots = 0;
+int sweep_root = 0;   /* index into sweep_roots of the component being walked */
+
+/* Bloom engine, see Engines above */
+
+#define BLOOM_FIELDS    8  /* FIELDs per row, at most */
+#define BLOOM_HASHES    8  /* bits set per ancestor, at most */
+
+FIELD bloom_rows[TOTAL_NODES][BLOOM_FIELDS];
+int bloom_fields = BLOOM_FIELDS;  /* FIELDs in use per row */
+int bloom_hashes = 4;             /* bits set per ancestor */
+int bloom_ones[TOTAL_NODES];      /* bits set in each row */
+double bloom_fill_sum = 0;        /* sum over rows of (fill fraction)^k */
+
+/* Reachability sketches, see Sketches above */
+
+#define HLL_REGISTERS   1024
+#define HLL_BITS        10  /* log2 of HLL_REGISTERS */
+#define SKETCH_FIELDS   (HLL_REGISTERS*4/FIELD_SIZE)
+
+int sketches = 0;                        /* -s */
+FIELD *ancestor_sketch[TOTAL_NODES];     /* allocated on first use */
+FIELD *descendant_sketch[TOTAL_NODES];
+
+/* Italiano engine, see Engines above */
+
+#define NO_NODE -1
+
+struct tree_entry {
+	int node;          /* NO_NODE for an empty slot */
+	int parent;        /* NO_NODE for the root */
+	int first_child;
+	int next_sibling;
+};
+
+struct reach_tree {
+	int size;                  /* entries in use */
+	int capacity;              /* slots, a power of 2 */
+	struct tree_entry *slots;  /* open addressing, linear probing */
+};
+
+struct ancestor_list {
+	int count;
+	int capacity;
+	unsigned short *nodes;     /* every x whose tree holds this node, x excepted */
+};
+
+struct reach_tree reach_trees[TOTAL_NODES];
+struct ancestor_list ancestor_lists[TOTAL_NODES];
+int meld_stack[TOTAL_NODES];
+
+/* Versions, see Versions above */
+
+#define VERSION_LEAF_FIELDS 64  /* FIELDs per leaf, 512 bytes */
+#define LEAVES_PER_ROW  (FIELDS_PER_NODE/VERSION_LEAF_FIELDS)
+#define VERSION_KEY_BITS 20     /* log2(TOTAL_NODES * LEAVES_PER_ROW) */
+#define VERSION_LEVELS  ((VERSION_KEY_BITS+4)/5)  /* 32 way trie levels */
+
+struct version_leaf {
+	int refs;
+	FIELD fields[VERSION_LEAF_FIELDS];
+};
+
+struct version_node {
+	long stamp;            /* id of the version that built this node */
+	int refs;
+	unsigned int bitmap;   /* which of the 32 children are present */
+	void *children[1];     /* one per bit set in bitmap, nodes or leaves */
+};
+
+struct version {
+	long id;
+	time_t time;
+	struct version_node *root;  /* NULL for an all-zero matrix */
+};
+
+int versions_kept = 0;          /* -v, 0 for no versions */
+struct version *versions;       /* ring of the last versions_kept versions */
+int n_versions = 0;
+int oldest_version = 0;         /* index in versions of the oldest kept */
+long next_version_id = 0;
+int dirty_leaves[TOTAL_NODES * LEAVES_PER_ROW];  /* keys written since the last version */
+int n_dirty_leaves = 0;
+unsigned char leaf_is_dirty[TOTAL_NODES * LEAVES_PER_ROW];
+
+/* Node names, see Names above */
+
+#define SYMBOL_SLOTS       (2*TOTAL_NODES)  /* a power of 2 */
+#define SYMBOL_ARENA_BYTES (64*TOTAL_NODES) /* room for names averaging 64 bytes */
+
+struct symbol_slot {
+	unsigned int hash;
+	int node;                         /* NO_NODE for an empty slot */
+};
 
-FIELD ancestors[TOTAL_NODES][FIELDS_PER_NODE];
+struct symbol_slot symbol_slots[SYMBOL_SLOTS];
+char symbol_arena[SYMBOL_ARENA_BYTES];
+int symbol_arena_used = 0;
+int symbol_offset[TOTAL_NODES];       /* name of node n in symbol_arena */
+int symbol_length[TOTAL_NODES];
+int n_symbols = 0;
+
+/* Input, see Handover above */
+
+#define INPUT_BYTES 65536
+#define LINE_BYTES 256        /* longest line read_line returns, with its '\0' */
+
+char input_buffer[INPUT_BYTES];
+int input_start = 0;          /* next unread byte */
+int input_end = 0;
+int input_eof = 0;
+long input_line = 0;          /* lines returned by read_line */
+
+/* Handover, see above */
+
+#define HANDOVER_MAGIC "CDHO"
+
+struct handover_header {
+	char magic[4];
+	int total_nodes;             /* must match in both binaries */
+	int field_bytes;
+	int engine;                  /* index in engines */
+	long state_bytes;
+};
+
+struct state_section {
+	void *base;
+	size_t size;
+};
+
+struct state_section state_sections[] = {
+	{ component_parent, sizeof(component_parent) },
+	{ component_next, sizeof(component_next) },
+	{ component_low, sizeof(component_low) },
+	{ component_high, sizeof(component_high) },
+	{ component_size, sizeof(component_size) },
+	{ ancestor_count, sizeof(ancestor_count) },
+	{ descendant_count, sizeof(descendant_count) },
+	{ &reachable_pairs, sizeof(reachable_pairs) },
+	{ &linked_nodes, sizeof(linked_nodes) },
+	{ &max_ancestors, sizeof(max_ancestors) },
+	{ &max_ancestors_node, sizeof(max_ancestors_node) },
+	{ &max_descendants, sizeof(max_descendants) },
+	{ &max_descendants_node, sizeof(max_descendants_node) },
+	{ top_nodes, sizeof(top_nodes) },
+	{ &n_top, sizeof(n_top) },
+	{ in_top, sizeof(in_top) },
+	{ &row_unions, sizeof(row_unions) },
+	{ &blocks_tested, sizeof(blocks_tested) },
+	{ &blocks_written, sizeof(blocks_written) },
+	{ pending, sizeof(pending) },
+	{ &n_pending, sizeof(n_pending) },
+	{ &n_sweeping, sizeof(n_sweeping) },
+	{ &sweep_row, sizeof(sweep_row) },
+	{ sweep_roots, sizeof(sweep_roots) },
+	{ &n_sweep_roots, sizeof(n_sweep_roots) },
+	{ &sweep_root, sizeof(sweep_root) },
+	{ bloom_rows, sizeof(bloom_rows) },
+	{ &bloom_fields, sizeof(bloom_fields) },
+	{ &bloom_hashes, sizeof(bloom_hashes) },
+	{ bloom_ones, sizeof(bloom_ones) },
+	{ &bloom_fill_sum, sizeof(bloom_fill_sum) },
+	{ symbol_slots, sizeof(symbol_slots) },
+	{ symbol_arena, sizeof(symbol_arena) },
+	{ &symbol_arena_used, sizeof(symbol_arena_used) },
+	{ symbol_offset, sizeof(symbol_offset) },
+	{ symbol_length, sizeof(symbol_length) },
+	{ &n_symbols, sizeof(n_symbols) },
+	{ input_buffer, sizeof(input_buffer) },
+	{ &input_start, sizeof(input_start) },
+	{ &input_end, sizeof(input_end) },
+	{ &input_eof, sizeof(input_eof) },
+	{ &input_line, sizeof(input_line) },
+	{ NULL, 0 }
+};
+
+int handover_listener = -1;   /* -H socket, or -1 */
+
+/* Pipeline, see above */
+
+#define RING_SLOTS 64            /* a power of two, also the number of batches */
+#define BATCH_LINKS 256
+#define RING_SPINS 64            /* yields before an idle stage sleeps */
+
+#define UNCHECKED -1             /* link results in a batch, besides FAIL, PASS, BAD_DATA */
+#define BLANK_LINE -2
+#define BAD_LINE -3
+#define NAMES_FULL -4
+#define INVALID_LINK -5          /* check_link fails; the formatter says why */
+#define LONG_LINE -6             /* too long for LINE_BYTES, also from read_line */
+
+struct link_batch {
+	int n_links;
+	int last;                    /* end of input */
+	char command[LINE_BYTES];    /* a dot-command, alone in its batch, or "" */
+	int start_node[BATCH_LINKS];
+	int end_node[BATCH_LINKS];
+	int result[BATCH_LINKS];
+	long line[BATCH_LINKS];      /* input_line, to report a BAD_LINE */
+};
+
+struct ring {
+	_Atomic unsigned head;       /* written by the consumer only */
+	char head_pad[64 - sizeof(unsigned)];
+	_Atomic unsigned tail;       /* written by the producer only */
+	char tail_pad[64 - sizeof(unsigned)];
+	int slots[RING_SLOTS];
+};
+
+struct link_batch link_batches[RING_SLOTS];
+struct ring free_ring, parsed_ring, checked_ring;
+_Atomic int batches_printed = 0;
+int pipeline_deferred = 0;
+
+/* Link logs, see above */
+
+#define LOG_MAGIC "CDLG"
+#define LOG_INDEX_MAGIC "CDIX"
+#define LOG_VERSION 1
+#define LOG_BLOCK_LINKS 4096
+#define LOG_HEADER_BYTES 8         /* magic, version */
+#define LOG_BLOCK_HEADER_BYTES 12  /* links, payload bytes, CRC-32 */
+#define LOG_INDEX_ENTRY_BYTES 16   /* offset (8 bytes), links, first start */
+#define LOG_TRAILER_BYTES 16       /* index offset (8 bytes), blocks, magic */
+#define MAX_VARINT_BYTES 5
+#define REPLAY_THREADS 8
+
+#define BLOCK_WAITING 0            /* block_state values */
+#define BLOCK_DECODED 1
+#define BLOCK_DAMAGED 2
+
+FILE *link_log = NULL;             /* -o, or NULL */
+struct link log_links[LOG_BLOCK_LINKS];
+int n_log_links = 0;
+unsigned char *log_index = NULL;   /* index entries of the blocks written */
+int n_log_blocks = 0;
+unsigned long long log_offset = 0;
+unsigned int crc_table[256];
+
+struct log_replay {
+	const unsigned char *base;       /* the mapped log */
+	const unsigned char *index;
+	unsigned long long index_offset;
+	int n_blocks;
+	long *first_link;                /* where each block goes in links */
+	struct batch_link *links;
+	_Atomic int *block_state;
+	_Atomic int next_block;
+} replay;
+
+/* Ingestion, see above */
+
+#define INGEST_SLICE_BYTES (1 << 20)
+#define INGEST_THREADS 8
+#define INGEST_WINDOW 8                /* slices parsed ahead of insertion */
+#define COMMAND_LINE -7                /* another ingest_line result */
+
+struct ingest_line {
+	int result;                          /* UNCHECKED, BAD_LINE or COMMAND_LINE */
+	int start_node;                      /* for a COMMAND_LINE, its offset in the slice */
+	int end_node;
+	int line;                            /* within the slice, from 1 */
+};
+
+struct ingest_slice {
+	_Atomic long ready;                  /* 1 + the number of the slice parsed here */
+	int n_lines;                         /* lines, blank or not */
+	int n_parsed;
+	int n_allocated;
+	struct ingest_line *lines;
+};
+
+struct file_ingest {
+	const char *base;                    /* the mapped file */
+	size_t size;
+	long n_slices;
+	_Atomic long next_slice;
+	_Atomic long n_inserted;             /* slices done by the main thread */
+	struct ingest_slice slices[INGEST_WINDOW];
+} ingest;
 
 /* Return values for insert_link function */
 
 #define FAIL 0
 #define PASS 1
 #define BAD_DATA 2
+#define MERGED 3     /* with -c, the link closed a cycle that was merged */
 
 /* Boolean Values */
 
 #define TRUE 1
 #define FALSE 0
 
+/* Engines */
+
+struct engine {
+	const char *name;
+	int  (*is_ancestor)(int n_node, int n_ancestor);
+	void (*insert_ancestors)(int start_node, int end_node);
+};
+
+/* Allocators, see Allocators above */
+
+#define ANY_NUMA_NODE -1
+#define PAGE_BYTES 4096
+#define HUGE_PAGE_BYTES (2 * 1024 * 1024)
+
+#define SLAB_MIN_BYTES 16
+#define SLAB_MAX_BYTES (64 * 1024)
+#define SLAB_CLASSES 13                 /* 16 bytes to 64KB */
+#define SLAB_CHUNK_BYTES (1024 * 1024)
+
+struct allocator {
+	const char *name;
+	void *(*allocate)(size_t size, size_t alignment, int numa_node);
+	void (*release)(void *memory, size_t size);
+};
+
+struct slab_class {
+	void *free_list;                /* each free block holds the next */
+	char *next;                     /* the rest of the current chunk */
+	char *end;
+} slab_classes[SLAB_CLASSES];
+
+/* Async requests, see Async Requests above */
+
+#define ASYNC_SLOTS 4096          /* requests submitted and not yet dispatched */
+#define ASYNC_PENDING -1          /* from async_insert and async_query, besides answers */
+#define ASYNC_BUSY -2
+
+#define ASYNC_INSERT 0            /* async_request kinds */
+#define ASYNC_QUERY 1
+#define ASYNC_COMMAND 2
+#define ASYNC_STOP 3
+
+typedef void (*async_callback)(int result, void *context);
+
+struct async_request {
+	int kind;
+	int start_node;               /* or the node of a query */
+	int end_node;                 /* or the ancestor of a query */
+	const char *command;
+	int result;
+	async_callback callback;
+	void *context;
+};
+
+struct {
+	pthread_mutex_t lock;
+	pthread_cond_t queued;
+	pthread_t thread;
+	int event_fd, wake_fd;        /* the pipe to the event loop */
+	int quick;                    /* requests may be answered without the executor */
+	unsigned long n_submitted, n_done, n_dispatched;
+	struct async_request requests[ASYNC_SLOTS];
+} async = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+struct async_line {               /* a -q line, until it is printed */
+	long line;
+	int start_node;
+	int end_node;
+	int result;                   /* UNCHECKED until answered */
+};
+
+struct async_line async_lines[ASYNC_SLOTS];
+long n_async_read = 0, n_async_printed = 0;
+
+/* Exports, see Exports above */
+
+#define EXPORT_VERSION 1
+#define EXPORT_RAW 2              /* a closure row format, besides the packed_row ones */
+
+struct edge_list {
+	int count;
+	int capacity;
+	unsigned short *nodes;        /* end nodes of links from this node */
+};
+
+int edges_kept = FALSE;           /* -E */
+struct edge_list out_edges[TOTAL_NODES];
+long n_edges = 0;
+int export_order[TOTAL_NODES];
+int export_starts[TOTAL_NODES + 1];
+unsigned short export_items[ROW_BYTES / sizeof(unsigned short)];
+
+/* Strong components, see Condensation above */
+
+int condensing = FALSE;           /* -c */
+unsigned short strong_parent[TOTAL_NODES];
+unsigned short strong_next[TOTAL_NODES];  /* circular member list */
+int strong_size[TOTAL_NODES];
+int n_folded = 0;                 /* nodes merged into another's component */
+int n_strong = 0;                 /* components of more than one node */
+FIELD merged_nodes[FIELDS_PER_NODE];
+
+/* Levels, see Levels above */
+
+int levels_kept = FALSE;          /* -L */
+unsigned short node_level[TOTAL_NODES];
+int level_stack[TOTAL_NODES];
+unsigned char level_stacked[TOTAL_NODES];
+int max_level = 0, max_level_node = 0;
+long level_raises = 0, level_prunes = 0;
+
 /* Function Prototypes */
 
 int  insert_link(int starting_node, int ending_node); 
+int  insert_link_deferred(int starting_node, int ending_node);
+int  check_link(int start_node, int end_node);
+int  valid_link(int starting_node, int ending_node);
+void insert_links_greedy(struct batch_link *links, int n_links);
+void run_batches(int atomic);
+void print_result(int result);
+int  compare_priority(const void *a, const void *b);
 void insert_ancestors(int starting_node, int ending_node);
+int  or_row(int n_descendant, int n_source);
 int  is_ancestor(int n_node, int n_ancestor);
+int  is_reachable(int n_node, int n_ancestor);
+int  overlay_reachable(int n_node, int n_ancestor, int n_links);
+int  insert_links_atomic(struct link *links, int n_links);
 void set_ancestor(int n_descendant, int n_ancestor);
-void initialize_ancestors(); 
+FIELD *row_of(int n_node);
+FIELD *writable_row(int n_node);
+void add_to_clock(int n_node);
+void enforce_row_budget();
+int  pack_row(int n_node);
+void count_row_items(const FIELD *row, int *n_bits, int *n_runs);
+int  row_items(const FIELD *row, int format, unsigned short *items);
+void unpack_row(int n_node);
+void unpack_all_rows();
+int  packed_has_bit(int n_node, int bit);
+unsigned short *rank_directory(int n_node);
+int  row_rank(int n_node, int bit);
+int  row_range_count(int n_node, int low, int high);
+int  row_select(int n_node, int k);
+void count_new_ancestors(int n_node, int n_field, FIELD new_bits);
+void update_top_nodes(int n_node);
+void get_closure_stats(struct closure_stats *stats);
+void print_closure_stats();
+void run_command(char *line);
+void initialize_components();
+int  find_component(int n_node);
+void join_components(int n_node, int n_other);
+int  propagate_pending(int max_rows);
+void drain_pending();
+int  read_line(char *line, int size);
+void fill_input();
+void skip_input_line();
+void print_long_line(long line);
+int  line_waiting();
+int  parse_pair(const char *line, int size, int *start_node, int *end_node);
+int  scan_pair(const char *line, int size, int *start_node, int *end_node);
+int  leading_digits(unsigned long long word);
+int  digits_value(unsigned long long word, int n_digits);
+void wait_for_input(int deferred);
+void initialize_matrix(int shared);
+int  slab_class_of(size_t size);
+void *map_pages(size_t size, size_t alignment, int huge);
+void *slab_allocate(size_t size, size_t alignment, int numa_node);
+void slab_release(void *memory, size_t size);
+void *huge_allocate(size_t size, size_t alignment, int numa_node);
+void huge_release(void *memory, size_t size);
+void listen_for_successor(const char *path);
+void hand_over();
+void take_over(const char *path);
+int  copy_state(int fd, int writing);
+void ring_push(struct ring *ring, int value);
+int  ring_pop(struct ring *ring, int *value);
+int  ring_take(struct ring *ring);
+void ring_wait(int *n_waits);
+void run_pipeline(int deferred, int named);
+struct link_batch *send_batch(struct link_batch *batch, int *n_sent);
+void *run_engine_stage(void *unused);
+void *run_formatter_stage(void *unused);
+void print_line_result(int result, long line, int start_node, int end_node);
+void start_async();
+void stop_async();
+int  async_fd();
+int  quick_bit(int n_node, int n_ancestor);
+int  async_insert(int start_node, int end_node, async_callback callback, void *context);
+int  async_query(int n_node, int n_ancestor, async_callback callback, void *context);
+int  submit_async(int kind, int start_node, int end_node, const char *command,
+									async_callback callback, void *context);
+void *run_async_executor(void *unused);
+int  dispatch_async();
+void wait_async();
+void run_async_lines(int named);
+void finish_async_line(int result, void *context);
+void print_async_lines();
+void keep_edge(int start_node, int end_node);
+void run_export(char *line);
+long export_closure(FILE *out, int binary);
+void export_packed_row(FILE *out, int n_node, const struct packed_row *packed, int binary);
+void write_export_items(FILE *out, int n_node, int format, int n_items, const unsigned short *items);
+long export_order_of_nodes(FILE *out, int binary);
+long export_reduction(FILE *out, int binary);
+int  compare_nodes(const void *a, const void *b);
+void initialize_strong_components();
+int  find_strong(int n_node);
+int  insert_link_condensed(int start_node, int end_node);
+void merge_strong_components(int start_node, int end_node);
+void forget_ancestors(int n_node, const FIELD *mask);
+void rescan_top_nodes();
+void print_strong_component(int n_node);
+void raise_levels(int start_node, int end_node);
+void print_level(int n_node);
+void print_level_stats();
+void open_link_log(const char *path);
+void log_link(int start_node, int end_node);
+void write_log_block();
+void close_link_log();
+int  compare_links(const void *a, const void *b);
+void replay_link_log(const char *path);
+void *decode_log_blocks(void *unused);
+int  decode_log_block(int n_block);
+void initialize_crc_table();
+unsigned int crc32_of(const unsigned char *bytes, size_t n_bytes);
+int  put_varint(unsigned char *bytes, unsigned int value);
+int  get_varint(const unsigned char *bytes, const unsigned char *end, unsigned int *value);
+void store_bytes(unsigned char *bytes, unsigned long long value, int n_bytes);
+unsigned long long load_bytes(const unsigned char *bytes, int n_bytes);
+void ingest_file(const char *path, int deferred);
+void *parse_slices(void *unused);
+void parse_slice(struct ingest_slice *slice, long n_slice);
+long slice_boundary(long n_slice);
+void release_pages(const void *base, size_t *released, size_t upto);
+int  bloom_is_ancestor(int n_node, int n_ancestor);
+void bloom_insert_ancestors(int start_node, int end_node);
+void bloom_or_row(int n_descendant, int n_source);
+void bloom_key(int n_ancestor, int *n_field, FIELD *mask);
+double bloom_false_positive_rate();
+unsigned long long mix_node(int n_node);
+void sketch_link(int start_node, int end_node);
+FIELD *sketch_of(FIELD **sketch);
+void add_to_sketch(FIELD *sketch, int n_node);
+void merge_sketch(FIELD *sketch, FIELD *other);
+FIELD max_registers(FIELD x, FIELD y);
+double estimate_sketch(FIELD *sketch);
+void print_counts(int n_node);
+void ancestor_set(int n_node, FIELD *set);
+void common_ancestors(const int *nodes, int n_nodes, FIELD *set);
+void any_ancestors(const int *nodes, int n_nodes, FIELD *set);
+void subtract_ancestors(const int *nodes, int n_nodes, FIELD *set);
+void reachable_from(const int *nodes, int n_nodes, FIELD *set);
+int  next_in_set(const FIELD *set, int n_node);
+void run_set_query(char *command, char *line);
+void print_rank(int n_node, int low, int high);
+void print_select(int n_node, int k);
+void count_new_pair(int n_node, int n_ancestor);
+int  italiano_is_ancestor(int n_node, int n_ancestor);
+void italiano_insert_ancestors(int start_node, int end_node);
+void meld_tree(int n_root, int start_node, int end_node);
+struct tree_entry *tree_find(struct reach_tree *tree, int n_node);
+void tree_add(int n_root, int n_node, int n_parent);
+void tree_grow(struct reach_tree *tree);
+void initialize_versions(int n_kept);
+void commit_version();
+void *version_set(struct version_node *node, int key, int level, struct version_leaf *leaf);
+void retain_version_node(void *node, int level);
+void release_version_node(void *node, int level);
+struct version *find_version(long id);
+long version_at_time(time_t when);
+int  is_ancestor_at(long id, int n_node, int n_ancestor);
+int  insert_link_at(long id, int start_node, int end_node);
+void print_versions();
+void initialize_symbols();
+unsigned int hash_name(const char *name, int length);
+int  intern_node(const char *name, int length);
+const char *node_name(int n_node, int *length);
+int  insert_link_named(const char *start_name, const char *end_name, int deferred);
+
+struct engine matrix_engine = { "matrix", is_ancestor, insert_ancestors };
+struct engine bloom_engine = { "bloom", bloom_is_ancestor, bloom_insert_ancestors };
+struct engine italiano_engine = { "italiano", italiano_is_ancestor, italiano_insert_ancestors };
+struct engine *engines[] = { &matrix_engine, &bloom_engine, &italiano_engine, NULL };
+struct engine *engine = &matrix_engine;
+
+struct allocator slab_allocator = { "slab", slab_allocate, slab_release };
+struct allocator huge_allocator = { "huge", huge_allocate, huge_release };
+struct allocator *allocators[] = { &slab_allocator, &huge_allocator, NULL };
+struct allocator *allocator = &slab_allocator;
 
 int insert_link(int start_node, int end_node) 
 {
-	if (start_node >= TOTAL_NODES) {
+	int result = check_link(start_node,end_node);
+
+	if (result != PASS)
+		return result;
+	if (condensing)
+		return insert_link_condensed(start_node,end_node);
+	drain_pending();
+	if (find_component(start_node) == find_component(end_node)
+			&& engine->is_ancestor(start_node,end_node)) {
+		return FAIL;
+	} else {
+		engine->insert_ancestors(start_node,end_node);
+		if (sketches)
+			sketch_link(start_node,end_node);
+		join_components(start_node,end_node);
+		if (versions_kept)
+			commit_version();
+		if (link_log)
+			log_link(start_node,end_node);
+		if (edges_kept)
+			keep_edge(start_node,end_node);
+		return PASS;
+	}
+}
+
+int insert_link_deferred(int start_node, int end_node) 
+{
+	/* Same answers as insert_link, but the row updates wait in pending[]. */
+	int result = check_link(start_node,end_node);
+
+	if (result != PASS)
+		return result;
+	if (engine != &matrix_engine)
+		return insert_link(start_node,end_node);
+	if (is_reachable(start_node,end_node))
+		return FAIL;
+	if (n_pending == PENDING_LINKS)
+		drain_pending();
+	pending[n_pending].start = start_node;
+	pending[n_pending].end = end_node;
+	n_pending++;
+	join_components(start_node,end_node);
+	if (link_log)
+		log_link(start_node,end_node);
+	if (edges_kept)
+		keep_edge(start_node,end_node);
+	return PASS;
+}
+
+/* The batch being ordered by insert_links_greedy, for compare_priority */
+static struct batch_link *batch_to_sort;
+
+void insert_links_greedy(struct batch_link *links, int n_links) 
+{
+	/* Accept links in priority order, rejecting those that close a cycle */
+	int *order = malloc(n_links * sizeof(int));
+	int i;
+
+	if (order == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory for batch of %d links\n", n_links);
+		exit(1);
+	}
+	for(i=0;i<n_links;i++)
+		order[i] = i;
+	batch_to_sort = links;
+	qsort(order, n_links, sizeof(int), compare_priority);
+	for(i=0;i<n_links;i++)
+		{
+			links[order[i]].result =
+				insert_link_deferred(links[order[i]].start, links[order[i]].end);
+		}
+	drain_pending();
+	free(order);
+}
+
+int insert_links_atomic(struct link *links, int n_links) 
+{
+	/* PASS if every link was inserted, otherwise nothing was inserted */
+	int i, result;
+
+	if (n_links > PENDING_LINKS) {
+		printf("input ignored: ");
+		printf("batch of %d links is larger than PENDING_LINKS (= %d)\n", n_links, PENDING_LINKS);
+		return BAD_DATA;
+	}
+	for(i=0;i<n_links;i++)
+		{
+			result = check_link(links[i].start, links[i].end);
+			if (result != PASS)
+				return result;
+		}
+	/* One generation for the whole batch, checked in the free overlay slots */
+	drain_pending();
+	for(i=0;i<n_links;i++)
+		{
+			if (overlay_reachable(links[i].start, links[i].end, i))
+				return FAIL;
+			pending[i] = links[i];
+		}
+	for(i=0;i<n_links;i++)
+		{
+			if (engine != &matrix_engine) {
+				engine->insert_ancestors(links[i].start, links[i].end);
+				if (sketches)
+					sketch_link(links[i].start, links[i].end);
+			}
+			join_components(links[i].start, links[i].end);
+			if (link_log)
+				log_link(links[i].start, links[i].end);
+			if (edges_kept)
+				keep_edge(links[i].start, links[i].end);
+		}
+	if (engine == &matrix_engine) {
+		n_pending = n_links;
+		drain_pending();
+	}
+	return PASS;
+}
+
+int compare_priority(const void *a, const void *b) 
+{
+	/* Highest priority first; equal priorities keep their batch order */
+	int i = *(const int *)a, j = *(const int *)b;
+
+	if (batch_to_sort[i].priority != batch_to_sort[j].priority)
+		return batch_to_sort[i].priority > batch_to_sort[j].priority ? -1 : 1;
+	return i - j;
+}
+
+int check_link(int start_node, int end_node) 
+{
+	/* Validation shared by the insert functions. PASS means "go ahead". */
+	if (start_node < 0 || start_node >= TOTAL_NODES) {
 		printf("input ignored: ");
-		printf("start (= %d) must be less than TOTAL_NODES (= %d)\n", start_node, TOTAL_NODES);
+		printf("start (= %d) must be from 0 to less than TOTAL_NODES (= %d)\n", start_node, TOTAL_NODES);
 		return BAD_DATA;
-  } else if (end_node >= TOTAL_NODES) {
+	} else if (end_node < 0 || end_node >= TOTAL_NODES) {
 		printf("input ignored: ");
-		printf("end (= %d) must be less than TOTAL_NODES (= %d)\n", end_node, TOTAL_NODES);
+		printf("end (= %d) must be from 0 to less than TOTAL_NODES (= %d)\n", end_node, TOTAL_NODES);
 		return BAD_DATA;
 	} else if (start_node == end_node) {
 		printf("input ignored: ");
 		printf("start and end are identical (= %d)\n", end_node);
 		return FAIL; /* This is a fail by definition */
-	} else if (is_ancestor(start_node,end_node)) {
-		return FAIL;
-	} else {
-		insert_ancestors(start_node,end_node);
-		return PASS;
 	}
+	return PASS;
+}
+
+int valid_link(int start_node, int end_node) 
+{
+	/* TRUE where check_link says PASS, without its complaints */
+	return start_node >= 0 && start_node < TOTAL_NODES && end_node >= 0 && end_node < TOTAL_NODES
+		&& start_node != end_node;
 }
 
 void insert_ancestors(int start_node, int end_node) 
 {
 	/* The meat of the program. Refer to Algorithm section above. */
-	int k, n_field;
+	int k = end_node;
 	
-	for(k=0;k<TOTAL_NODES;k++)
+	do
 		{
+			/* Only end_node's component can hold its descendants */
 			if (is_ancestor(k,end_node))
-				{
-					for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
-						{
-							ancestors[k][n_field] |= ancestors[start_node][n_field];
-						}
-				}
- 		}
+				or_row(k,start_node);
+			k = component_next[k];
+ 		} while (k != end_node);
 	return;
 }
 
-void initialize_ancestors() 
+int or_row(int n_descendant, int n_source) 
 {
-	/* By definition all self links (x->x) are closing links. */
-	int i;
-	for(i=0;i<TOTAL_NODES;i++)
+	/*
+		ancestors[n_descendant] |= ancestors[n_source] plus n_source itself,
+		storing only the blocks that gain bits. Returns the number of blocks
+		written.
+	*/
+	FIELD *descendant_row = writable_row(n_descendant);
+	FIELD *source_row = row_of(n_source);
+	FIELD new_bits[BLOCK_FIELDS], any_new;
+	int n_source_field = n_source / FIELD_SIZE;
+	FIELD source_bit = (FIELD)1 << (n_source % FIELD_SIZE);
+	int root = find_component(n_source);
+	int n_block, n_field, i, n_written = 0;
+	int n_last = component_high[root] / FIELD_SIZE / BLOCK_FIELDS;
+
+	/* The ancestors of n_source are all members of its component */
+	for(n_block=component_low[root]/FIELD_SIZE/BLOCK_FIELDS;n_block<=n_last;n_block++)
 		{
-			set_ancestor(i,i);
+			n_field = n_block * BLOCK_FIELDS;
+			any_new = 0;
+			for(i=0;i<BLOCK_FIELDS;i++)
+				{
+					new_bits[i] = source_row[n_field+i];
+					if (n_field + i == n_source_field)
+						new_bits[i] |= source_bit;
+					new_bits[i] &= ~descendant_row[n_field+i];
+					any_new |= new_bits[i];
+				}
+			if (!any_new)
+				continue;
+			for(i=0;i<BLOCK_FIELDS;i++)
+				{
+					/* Atomic for quick_bit, see Async Requests; a plain store on x86-64 */
+					__atomic_store_n(&descendant_row[n_field+i], descendant_row[n_field+i] | new_bits[i],
+													 __ATOMIC_RELAXED);
+					if (new_bits[i])
+						count_new_ancestors(n_descendant, n_field + i, new_bits[i]);
+				}
+			n_written++;
+			i = n_descendant * LEAVES_PER_ROW + n_field / VERSION_LEAF_FIELDS;
+			if (versions_kept && !leaf_is_dirty[i]) {
+				leaf_is_dirty[i] = TRUE;
+				dirty_leaves[n_dirty_leaves++] = i;
+			}
 		}
+	if (n_written)
+		rank_valid[n_descendant] = FALSE;
+	row_unions++;
+	blocks_tested += n_last - component_low[root]/FIELD_SIZE/BLOCK_FIELDS + 1;
+	blocks_written += n_written;
+	return n_written;
 }
 
-int is_ancestor(int n_node, int n_ancestor) 
+void count_new_ancestors(int n_node, int n_field, FIELD new_bits) 
 {
-	int n_target_chunk = n_ancestor / FIELD_SIZE;
-	int n_target_bit = n_ancestor % FIELD_SIZE;
-	FIELD bit_to_get = 1 << n_target_bit;
+	/* Statistics for the ancestors new_bits in FIELD n_field of row n_node */
+	int n_new = __builtin_popcountl(new_bits);
+	int n_ancestor;
 
-	if(ancestors[n_node][n_target_chunk] & bit_to_get)
-		return(TRUE);
-	else 
-		return(FALSE);
+	ancestor_count[n_node] += n_new;
+	reachable_pairs += n_new;
+	if (ancestor_count[n_node] > max_ancestors) {
+		max_ancestors = ancestor_count[n_node];
+		max_ancestors_node = n_node;
+	}
+	update_top_nodes(n_node);
+	while (new_bits) {
+		n_ancestor = n_field * FIELD_SIZE + __builtin_ctzl(new_bits);
+		new_bits &= new_bits - 1;
+		descendant_count[n_ancestor]++;
+		if (descendant_count[n_ancestor] > max_descendants) {
+			max_descendants = descendant_count[n_ancestor];
+			max_descendants_node = n_ancestor;
+		}
+		update_top_nodes(n_ancestor);
+	}
 }
 
-void set_ancestor(int n_descendant, int n_ancestor) 
+void count_new_pair(int n_node, int n_ancestor) 
 {
-	int n_target_chunk = n_ancestor / FIELD_SIZE;
-	int n_target_bit  = n_ancestor % FIELD_SIZE;
-	int bit_to_set = 1 << n_target_bit;
+	/* Statistics for a single new ancestor, for engines without rows */
+	ancestor_count[n_node]++;
+	reachable_pairs++;
+	if (ancestor_count[n_node] > max_ancestors) {
+		max_ancestors = ancestor_count[n_node];
+		max_ancestors_node = n_node;
+	}
+	update_top_nodes(n_node);
+	descendant_count[n_ancestor]++;
+	if (descendant_count[n_ancestor] > max_descendants) {
+		max_descendants = descendant_count[n_ancestor];
+		max_descendants_node = n_ancestor;
+	}
+	update_top_nodes(n_ancestor);
+}
 
-	ancestors[n_descendant][n_target_chunk] |= bit_to_set;
+void update_top_nodes(int n_node) 
+{
+	/* n_node's connections have grown: move it up or into top_nodes */
+	int i, connections = ancestor_count[n_node] + descendant_count[n_node];
 
-	return;
+	if (in_top[n_node]) {
+		for(i=0;top_nodes[i]!=n_node;i++)
+			;
+	} else if (n_top < TOP_NODES) {
+		i = n_top++;
+	} else {
+		i = TOP_NODES - 1;
+		if (connections <= ancestor_count[top_nodes[i]] + descendant_count[top_nodes[i]])
+			return;
+		in_top[top_nodes[i]] = FALSE;
+	}
+	in_top[n_node] = TRUE;
+	for(;i>0 && connections > ancestor_count[top_nodes[i-1]] + descendant_count[top_nodes[i-1]];i--)
+		top_nodes[i] = top_nodes[i-1];
+	top_nodes[i] = n_node;
 }
 
-int main () 
+void get_closure_stats(struct closure_stats *stats) 
 {
-	int start_node, end_node, result;
-	initialize_ancestors();
+	int i;
+
+	stats->reachable_pairs = reachable_pairs;
+	stats->linked_nodes = linked_nodes;
+	/* With -c the averages are over the condensed graph */
+	stats->average_ancestors = linked_nodes ? (double)reachable_pairs / (linked_nodes - n_folded) : 0;
+	stats->average_descendants = stats->average_ancestors;
+	stats->max_ancestors = max_ancestors;
+	stats->max_ancestors_node = max_ancestors_node;
+	stats->max_descendants = max_descendants;
+	stats->max_descendants_node = max_descendants_node;
+	stats->n_top = n_top;
+	for(i=0;i<n_top;i++)
+		{
+			stats->top_nodes[i] = top_nodes[i];
+			stats->top_connections[i] = ancestor_count[top_nodes[i]] + descendant_count[top_nodes[i]];
+		}
+	stats->row_unions = row_unions;
+	stats->blocks_tested = blocks_tested;
+	stats->blocks_written = blocks_written;
+}
+
+int propagate_pending(int max_rows) 
+{
+	/*
+		Visit up to max_rows rows on behalf of the pending links. Returns the
+		number of links still pending. See Deferred Propagation above.
+	*/
+	int i, j, k, n_rows = 0;
+
+	if (n_sweeping == 0) {
+		if (n_pending == 0)
+			return 0;
+		n_sweeping = n_pending;
+		n_sweep_roots = 0;
+		for(j=0;j<n_sweeping;j++)
+			{
+				k = find_component(pending[j].end);
+				for(i=0;i<n_sweep_roots && sweep_roots[i]!=k;i++)
+					;
+				if (i == n_sweep_roots)
+					sweep_roots[n_sweep_roots++] = k;
+			}
+		sweep_root = 0;
+		sweep_row = sweep_roots[0];
+		for(j=0;j<n_sweeping;j++)
+			{
+				for(i=0;i<n_sweeping;i++)
+					{
+						if (is_ancestor(pending[i].start,pending[j].end))
+							or_row(pending[i].start,pending[j].start);
+					}
+			}
+	}
+	/*
+		Walk the member lists of the components holding the generation's end
+		nodes. Components merged since the generation began are still walked
+		to completion, since sweep_roots[sweep_root] stays on the merged list.
+	*/
+	while (sweep_root < n_sweep_roots && n_rows++ < max_rows) {
+		k = sweep_row;
+		for(j=0;j<n_sweeping;j++)
+			{
+				if (is_ancestor(k,pending[j].end))
+					or_row(k,pending[j].start);
+			}
+		sweep_row = component_next[k];
+		if (sweep_row == sweep_roots[sweep_root] && ++sweep_root < n_sweep_roots)
+			sweep_row = sweep_roots[sweep_root];
+	}
+	if (sweep_root == n_sweep_roots) {
+		for(j=0;j<n_sweeping && sketches;j++)
+			sketch_link(pending[j].start,pending[j].end);
+		if (versions_kept)
+			commit_version();
+		n_pending -= n_sweeping;
+		memmove(pending, pending + n_sweeping, n_pending * sizeof(struct link));
+		n_sweeping = 0;
+	}
+	return n_pending;
+}
+
+void drain_pending() 
+{
+	while (propagate_pending(TOTAL_NODES) > 0)
+		;
+}
+
+int is_reachable(int n_node, int n_ancestor) 
+{
+	/* Exact version of is_ancestor while links are pending */
+	if (find_component(n_node) != find_component(n_ancestor))
+		return(FALSE);
+	return overlay_reachable(n_node,n_ancestor,n_pending);
+}
+
+int overlay_reachable(int n_node, int n_ancestor, int n_links) 
+{
+	/*
+		Search for a chain of links from the first n_links of pending[] leading
+		from n_ancestor to n_node. n_links may run past n_pending to include
+		links that are only being tried out.
+	*/
+	static unsigned char reached[PENDING_LINKS];
+	static int queue[PENDING_LINKS];
+	int head = 0, tail = 0;
+	int j, end_node, leveled = levels_kept && n_links <= n_pending;
+
+	if (engine->is_ancestor(n_node,n_ancestor))
+		return(TRUE);
+	for(j=0;j<n_links;j++)
+		{
+			reached[j] = engine->is_ancestor(pending[j].start,n_ancestor);
+			if (reached[j])
+				queue[tail++] = j;
+		}
+	while (head < tail) {
+		end_node = pending[queue[head++]].end;
+		if (engine->is_ancestor(n_node,end_node))
+			return(TRUE);
+		/* Nothing from end_node reaches a node no higher than it; see Levels */
+		if (leveled && node_level[end_node] >= node_level[n_node]) {
+			level_prunes++;
+			continue;
+		}
+		for(j=0;j<n_links;j++)
+			{
+				if (!reached[j] && engine->is_ancestor(pending[j].start,end_node)) {
+					reached[j] = TRUE;
+					queue[tail++] = j;
+				}
+			}
+	}
+	return(FALSE);
+}
+
+int read_line(char *line, int size) 
+{
+	/*
+		fgets for standard input, read through input_buffer. Returns FALSE at
+		the end of input, and LONG_LINE, with line empty, for a line of more
+		than size - 1 characters, which is skipped up to its newline.
+	*/
+	char *newline = NULL;
+	int length;
+
 	while (TRUE) {
-		printf ("Enter start end:  ");
-		scanf ("%d %d", &start_node, &end_node);
-		result = insert_link(start_node, end_node);
-		if(result == FAIL) 
+		newline = memchr(input_buffer + input_start, '\n', input_end - input_start);
+		if (newline || input_eof || input_end - input_start >= size)
+			break;
+		fill_input();
+	}
+	length = newline ? newline - (input_buffer + input_start) : input_end - input_start;
+	if (length > size - 1) {
+		skip_input_line();
+		line[0] = '\0';
+		input_line++;
+		return LONG_LINE;
+	}
+	if (newline && length < size - 1)
+		length++;
+	if (length == 0)
+		return FALSE;
+	memcpy(line, input_buffer + input_start, length);
+	line[length] = '\0';
+	input_start += length;
+	if (newline && input_buffer + input_start == newline)
+		input_start++;    /* the newline did not fit, but the line did */
+	input_line++;
+	return TRUE;
+}
+
+void fill_input() 
+{
+	/* Read more of standard input into input_buffer, after what is unread */
+	int n_read;
+
+	if (input_start > 0) {
+		memmove(input_buffer, input_buffer + input_start, input_end - input_start);
+		input_end -= input_start;
+		input_start = 0;
+	}
+	n_read = read(0, input_buffer + input_end, INPUT_BYTES - input_end);
+	if (n_read > 0)
+		input_end += n_read;
+	else if (n_read == 0 || errno != EINTR)
+		input_eof = TRUE;
+}
+
+void skip_input_line() 
+{
+	/* Discard input up to and including the next newline */
+	char *newline;
+
+	while (TRUE) {
+		newline = memchr(input_buffer + input_start, '\n', input_end - input_start);
+		if (newline) {
+			input_start = newline + 1 - input_buffer;
+			return;
+		}
+		input_start = input_end;
+		if (input_eof)
+			return;
+		fill_input();
+	}
+}
+
+void print_long_line(long line) 
+{
+	printf("input ignored: line %ld is longer than %d characters\n", line, LINE_BYTES - 1);
+}
+
+int parse_pair(const char *line, int size, int *start_node, int *end_node) 
+{
+	/*
+		sscanf(line, "%d %d", start_node, end_node) for a line in a buffer of
+		size bytes. See Parsing above.
+	*/
+	if (scan_pair(line, size, start_node, end_node))
+		return 2;
+	return sscanf(line, "%d %d", start_node, end_node);
+}
+
+int scan_pair(const char *line, int size, int *start_node, int *end_node) 
+{
+	/*
+		The fast path of parse_pair, FALSE if the line is not simple. The line
+		need not end in '\0', but size bytes must be readable.
+	*/
+	unsigned long long word;
+	int n_start, n_end, at;
+
+	if (size >= 8) {
+		memcpy(&word, line, 8);
+		n_start = leading_digits(word);
+		for(at=n_start;at<size-8 && line[at]==' ';at++)
+			;
+		if (n_start > 0 && n_start < 8 && at > n_start && at <= size - 8) {
+			*start_node = digits_value(word, n_start);
+			memcpy(&word, line + at, 8);
+			n_end = leading_digits(word);
+			if (n_end > 0 && n_end < 8) {
+				*end_node = digits_value(word, n_end);
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+int leading_digits(unsigned long long word) 
+{
+	/* How many of the 8 characters in word, first in the low byte, are digits */
+	unsigned long long x = word ^ 0x3030303030303030ULL;
+	unsigned long long not_digit = (((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7676767676767676ULL) | x)
+		& 0x8080808080808080ULL;
+
+	return not_digit ? __builtin_ctzll(not_digit) / 8 : 8;
+}
+
+int digits_value(unsigned long long word, int n_digits) 
+{
+	/*
+		The number in the first n_digits (1 to 8) characters of word. Shifting
+		the digits to the top leaves leading zeros, then neighbouring digits,
+		pairs and quads are combined by multiplication.
+	*/
+	unsigned long long x = (word ^ 0x3030303030303030ULL) << (8 * (8 - n_digits));
+
+	x = x * 10 + (x >> 8);
+	x = ((x & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32))
+			 + ((x >> 16) & 0x000000ff000000ffULL) * (1 + (10000ULL << 32))) >> 32;
+	return x;
+}
+
+int line_waiting() 
+{
+	/* TRUE if read_line can return without reading */
+	return input_eof || memchr(input_buffer + input_start, '\n', input_end - input_start) != NULL;
+}
+
+void wait_for_input(int deferred) 
+{
+	/*
+		Return once standard input has something to read. Meanwhile run
+		deferred propagation and answer a successor on the handover socket.
+	*/
+	struct pollfd fds[2];
+	int n_fds = 1, n_ready, waiting, busy;
+
+	fds[0].fd = 0;
+	fds[0].events = POLLIN;
+	if (handover_listener >= 0) {
+		fds[1].fd = handover_listener;
+		fds[1].events = POLLIN;
+		n_fds = 2;
+	}
+	while (TRUE) {
+		waiting = line_waiting();
+		if (waiting && handover_listener < 0)
+			return;
+		/* Look at the socket even under a steady stream of input */
+		busy = deferred && n_pending > 0;
+		n_ready = poll(fds, n_fds, waiting || busy ? 0 : -1);
+		if (n_ready > 0 && n_fds == 2 && fds[1].revents)
+			hand_over();
+		if (waiting || (n_ready > 0 && fds[0].revents))
+			return;
+		if (busy)
+			propagate_pending(SLICE_ROWS);
+	}
+}
+
+void initialize_matrix(int shared) 
+{
+	/*
+		Map the ancestors matrix. Pages stay unbacked until written. A shared
+		matrix lives in a memfd that can be handed to a successor.
+	*/
+	size_t size = sizeof(FIELD) * FIELDS_PER_NODE * TOTAL_NODES;
+	void *base = MAP_FAILED;
+
+#ifdef __linux__
+	if (shared) {
+		matrix_fd = memfd_create("cycle_detector matrix", 0);
+		if (matrix_fd >= 0 && ftruncate(matrix_fd, size) == 0)
+			base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, matrix_fd, 0);
+	} else
+#endif
+	if ((base = allocator->allocate(size, PAGE_BYTES, ANY_NUMA_NODE)) == NULL)
+		base = MAP_FAILED;
+	if (base == MAP_FAILED) {
+		perror("cycle_detector: cannot map the ancestors matrix");
+		exit(1);
+	}
+	ancestors = base;
+}
+
+int slab_class_of(size_t size) 
+{
+	/* The smallest slab class holding size bytes, or -1 if none does */
+	int n_class = 0;
+
+	while (n_class < SLAB_CLASSES && (size_t)SLAB_MIN_BYTES << n_class < size)
+		n_class++;
+	return n_class < SLAB_CLASSES ? n_class : -1;
+}
+
+void *map_pages(size_t size, size_t alignment, int huge) 
+{
+	/* Map size bytes aligned to alignment, with transparent huge pages if huge */
+	size_t extra = alignment > PAGE_BYTES ? alignment : 0;
+	char *base, *aligned;
+
+	base = mmap(NULL, size + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+		return NULL;
+	aligned = base;
+	if (extra) {
+		aligned = (char *)(((unsigned long)base + alignment - 1) & ~(unsigned long)(alignment - 1));
+		if (aligned > base)
+			munmap(base, aligned - base);
+		munmap(aligned + size, base + extra - aligned);
+	}
+#ifdef MADV_HUGEPAGE
+	if (huge)
+		madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+	return aligned;
+}
+
+void *slab_allocate(size_t size, size_t alignment, int numa_node) 
+{
+	/* Take a block from the free list of its class, or carve a new one */
+	int n_class = slab_class_of(size > alignment ? size : alignment);
+	struct slab_class *slab;
+	size_t block;
+	void *memory;
+
+	if (alignment > PAGE_BYTES)
+		return NULL;
+	if (n_class < 0)
+		return map_pages((size + PAGE_BYTES - 1) & ~(size_t)(PAGE_BYTES - 1), alignment, FALSE);
+	slab = &slab_classes[n_class];
+	block = (size_t)SLAB_MIN_BYTES << n_class;
+	if (slab->free_list) {
+		memory = slab->free_list;
+		slab->free_list = *(void **)memory;
+		memset(memory, 0, size);
+		return memory;
+	}
+	if (slab->next == slab->end) {
+		if ((slab->next = map_pages(SLAB_CHUNK_BYTES, PAGE_BYTES, FALSE)) == NULL) {
+			slab->end = NULL;
+			return NULL;
+		}
+		slab->end = slab->next + SLAB_CHUNK_BYTES;
+	}
+	memory = slab->next;
+	slab->next += block;
+	return memory;
+}
+
+void slab_release(void *memory, size_t size) 
+{
+	/* Push the block on the free list of its class */
+	int n_class = slab_class_of(size);
+
+	if (memory == NULL)
+		return;
+	if (n_class < 0) {
+		munmap(memory, (size + PAGE_BYTES - 1) & ~(size_t)(PAGE_BYTES - 1));
+		return;
+	}
+	*(void **)memory = slab_classes[n_class].free_list;
+	slab_classes[n_class].free_list = memory;
+}
+
+void *huge_allocate(size_t size, size_t alignment, int numa_node) 
+{
+	/* Map a large request on huge pages; see Allocators */
+	if (size < HUGE_PAGE_BYTES)
+		return slab_allocate(size, alignment, numa_node);
+	return map_pages((size + HUGE_PAGE_BYTES - 1) & ~(size_t)(HUGE_PAGE_BYTES - 1), HUGE_PAGE_BYTES, TRUE);
+}
+
+void huge_release(void *memory, size_t size) 
+{
+	if (size < HUGE_PAGE_BYTES)
+		slab_release(memory, size);
+	else if (memory)
+		munmap(memory, (size + HUGE_PAGE_BYTES - 1) & ~(size_t)(HUGE_PAGE_BYTES - 1));
+}
+
+void listen_for_successor(const char *path) 
+{
+	struct sockaddr_un address;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+	unlink(path);
+	handover_listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (handover_listener < 0 || bind(handover_listener, (struct sockaddr *)&address, sizeof(address)) < 0
+			|| listen(handover_listener, 1) < 0) {
+		perror("cycle_detector: cannot listen for a successor");
+		exit(1);
+	}
+}
+
+void hand_over() 
+{
+	/* Pass everything to the process connecting on the handover socket */
+	struct handover_header header;
+	struct msghdr message;
+	struct iovec part;
+	struct cmsghdr *control;
+	char control_buffer[CMSG_SPACE(3 * sizeof(int))];
+	int fds[3], connection, state_fd = -1, i;
+	char ack;
+
+	connection = accept(handover_listener, NULL, NULL);
+	if (connection < 0)
+		return;
+	unpack_all_rows();
+#ifdef __linux__
+	state_fd = memfd_create("cycle_detector state", 0);
+#endif
+	if (state_fd < 0 || copy_state(state_fd, TRUE) < 0) {
+		fprintf(stderr, "cycle_detector: cannot save state for a successor\n");
+		close(connection);
+		return;
+	}
+	memcpy(header.magic, HANDOVER_MAGIC, 4);
+	header.total_nodes = TOTAL_NODES;
+	header.field_bytes = sizeof(FIELD);
+	for(i=0;engines[i]!=engine;i++)
+		;
+	header.engine = i;
+	header.state_bytes = lseek(state_fd, 0, SEEK_CUR);
+	fds[0] = matrix_fd;
+	fds[1] = state_fd;
+	fds[2] = 0;
+
+	memset(&message, 0, sizeof(message));
+	part.iov_base = &header;
+	part.iov_len = sizeof(header);
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = control_buffer;
+	message.msg_controllen = sizeof(control_buffer);
+	control = CMSG_FIRSTHDR(&message);
+	control->cmsg_level = SOL_SOCKET;
+	control->cmsg_type = SCM_RIGHTS;
+	control->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(control), fds, sizeof(fds));
+
+	fflush(stdout);
+	if (sendmsg(connection, &message, 0) == sizeof(header) && read(connection, &ack, 1) == 1) {
+		fprintf(stderr, "cycle_detector: handed over to a successor\n");
+		exit(0);
+	}
+	/* The successor gave up, so carry on serving */
+	fprintf(stderr, "cycle_detector: handover failed, still serving\n");
+	close(state_fd);
+	close(connection);
+}
+
+void take_over(const char *path) 
+{
+	/* Adopt the state of the process listening on path, see Handover */
+	struct sockaddr_un address;
+	struct handover_header header;
+	struct msghdr message;
+	struct iovec part;
+	struct cmsghdr *control;
+	char control_buffer[CMSG_SPACE(3 * sizeof(int))];
+	int fds[3], connection;
+	void *base;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+	connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0 || connect(connection, (struct sockaddr *)&address, sizeof(address)) < 0) {
+		perror("cycle_detector: cannot reach the process to take over");
+		exit(1);
+	}
+	memset(&message, 0, sizeof(message));
+	part.iov_base = &header;
+	part.iov_len = sizeof(header);
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = control_buffer;
+	message.msg_controllen = sizeof(control_buffer);
+	control = CMSG_FIRSTHDR(&message);
+	if (recvmsg(connection, &message, MSG_WAITALL) != sizeof(header)
+			|| (control = CMSG_FIRSTHDR(&message)) == NULL
+			|| control->cmsg_type != SCM_RIGHTS || control->cmsg_len != CMSG_LEN(sizeof(fds))) {
+		fprintf(stderr, "cycle_detector: no state received from %s\n", path);
+		exit(1);
+	}
+	memcpy(fds, CMSG_DATA(control), sizeof(fds));
+	if (memcmp(header.magic, HANDOVER_MAGIC, 4) != 0 || header.total_nodes != TOTAL_NODES
+			|| header.field_bytes != sizeof(FIELD) || header.engine < 0
+			|| header.engine >= (int)(sizeof(engines) / sizeof(engines[0])) - 1) {
+		fprintf(stderr, "cycle_detector: state from %s does not fit this binary\n", path);
+		exit(1);
+	}
+	base = mmap(NULL, sizeof(FIELD) * FIELDS_PER_NODE * TOTAL_NODES, PROT_READ | PROT_WRITE,
+							MAP_SHARED, fds[0], 0);
+	if (base == MAP_FAILED || lseek(fds[1], 0, SEEK_SET) != 0
+			|| copy_state(fds[1], FALSE) != header.state_bytes) {
+		fprintf(stderr, "cycle_detector: cannot load the state from %s\n", path);
+		exit(1);
+	}
+	if (matrix_fd >= 0) {
+		munmap(ancestors, sizeof(FIELD) * FIELDS_PER_NODE * TOTAL_NODES);
+		close(matrix_fd);
+	} else
+		allocator->release(ancestors, sizeof(FIELD) * FIELDS_PER_NODE * TOTAL_NODES);
+	ancestors = base;
+	matrix_fd = fds[0];
+	engine = engines[header.engine];
+	close(fds[1]);
+	dup2(fds[2], 0);
+	close(fds[2]);
+	if (write(connection, "k", 1) != 1) {
+		fprintf(stderr, "cycle_detector: lost %s during takeover\n", path);
+		exit(1);
+	}
+	close(connection);
+}
+
+int copy_state(int fd, int writing) 
+{
+	/*
+		Write state_sections to fd, or read them back. Returns the bytes
+		copied, or -1.
+	*/
+	struct state_section *section;
+	size_t done;
+	ssize_t n_bytes;
+	long total = 0;
+
+	for(section=state_sections;section->base;section++)
+		{
+			for(done=0;done<section->size;done+=n_bytes)
+				{
+					if (writing)
+						n_bytes = write(fd, (char *)section->base + done, section->size - done);
+					else
+						n_bytes = read(fd, (char *)section->base + done, section->size - done);
+					if (n_bytes <= 0)
+						return -1;
+				}
+			total += section->size;
+		}
+	return total;
+}
+
+void ring_push(struct ring *ring, int value) 
+{
+	/* Never full, since there are only RING_SLOTS batches */
+	unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	ring->slots[tail % RING_SLOTS] = value;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+int ring_pop(struct ring *ring, int *value) 
+{
+	unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+		return FALSE;
+	*value = ring->slots[head % RING_SLOTS];
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return TRUE;
+}
+
+int ring_take(struct ring *ring) 
+{
+	int value, n_waits = 0;
+
+	while (!ring_pop(ring, &value))
+		ring_wait(&n_waits);
+	return value;
+}
+
+void ring_wait(int *n_waits) 
+{
+	struct timespec pause = { 0, 50000 };
+
+	if ((*n_waits)++ < RING_SPINS)
+		sched_yield();
+	else
+		nanosleep(&pause, NULL);
+}
+
+void run_pipeline(int deferred, int named) 
+{
+	/* Line mode on three threads, see Pipeline */
+	pthread_t engine_thread, formatter_thread;
+	struct link_batch *batch;
+	char line[LINE_BYTES], start_name[LINE_BYTES], end_name[LINE_BYTES];
+	int i, n, result, n_sent = 0, n_waits;
+
+	pipeline_deferred = deferred;
+	for(i=0;i<RING_SLOTS;i++)
+		ring_push(&free_ring, i);
+	if (pthread_create(&engine_thread, NULL, run_engine_stage, NULL) != 0
+			|| pthread_create(&formatter_thread, NULL, run_formatter_stage, NULL) != 0) {
+		perror("cycle_detector: cannot start the pipeline");
+		exit(1);
+	}
+	batch = send_batch(NULL, &n_sent);
+	while (TRUE) {
+		if (batch->n_links > 0 && (batch->n_links == BATCH_LINKS || !line_waiting()))
+			batch = send_batch(batch, &n_sent);
+		result = read_line(line, sizeof(line));
+		if (!result)
+			break;
+		if (line[0] == '.') {
+			if (batch->n_links > 0)
+				batch = send_batch(batch, &n_sent);
+			strcpy(batch->command, line);
+			batch = send_batch(batch, &n_sent);
+			for(n_waits=0;atomic_load(&batches_printed) != n_sent;)
+				ring_wait(&n_waits);
+			continue;
+		}
+		n = batch->n_links++;
+		batch->line[n] = input_line;
+		if (result == LONG_LINE) {
+			batch->result[n] = LONG_LINE;
+			continue;
+		}
+		if (named) {
+			result = sscanf(line, "%255s %255s", start_name, end_name);
+			if (result == 2) {
+				batch->start_node[n] = intern_node(start_name, strlen(start_name));
+				batch->end_node[n] = intern_node(end_name, strlen(end_name));
+				if (batch->start_node[n] == NO_NODE || batch->end_node[n] == NO_NODE)
+					result = NAMES_FULL;
+			}
+		} else {
+			result = parse_pair(line, sizeof(line), &batch->start_node[n], &batch->end_node[n]);
+		}
+		if (result == EOF)
+			batch->result[n] = BLANK_LINE;
+		else if (result == NAMES_FULL)
+			batch->result[n] = NAMES_FULL;
+		else if (result != 2)
+			batch->result[n] = BAD_LINE;
+		else if (!valid_link(batch->start_node[n], batch->end_node[n]))
+			batch->result[n] = INVALID_LINK;
+		else
+			batch->result[n] = UNCHECKED;
+	}
+	batch->last = TRUE;
+	send_batch(batch, &n_sent);
+	pthread_join(engine_thread, NULL);
+	pthread_join(formatter_thread, NULL);
+}
+
+struct link_batch *send_batch(struct link_batch *batch, int *n_sent) 
+{
+	/* Pass batch to the engine, if any, and return an empty one */
+	if (batch) {
+		ring_push(&parsed_ring, batch - link_batches);
+		if (batch->last)
+			return NULL;
+		(*n_sent)++;
+	}
+	batch = &link_batches[ring_take(&free_ring)];
+	batch->n_links = 0;
+	batch->last = FALSE;
+	batch->command[0] = '\0';
+	return batch;
+}
+
+void *run_engine_stage(void *unused) 
+{
+	struct link_batch *batch;
+	int i, n_batch, n_forwarded = 0, n_waits = 0;
+
+	while (TRUE) {
+		if (!ring_pop(&parsed_ring, &n_batch)) {
+			if (pipeline_deferred && n_pending > 0)
+				propagate_pending(SLICE_ROWS);
+			else
+				ring_wait(&n_waits);
+			continue;
+		}
+		n_waits = 0;
+		batch = &link_batches[n_batch];
+		for(i=0;i<batch->n_links;i++)
+			{
+				if (batch->result[i] != UNCHECKED)
+					continue;
+				if (pipeline_deferred)
+					batch->result[i] = insert_link_deferred(batch->start_node[i], batch->end_node[i]);
+				else
+					batch->result[i] = insert_link(batch->start_node[i], batch->end_node[i]);
+			}
+		if (batch->command[0]) {
+			while (atomic_load(&batches_printed) != n_forwarded)
+				ring_wait(&n_waits);
+			printf("Enter start end:  ");
+			run_command(batch->command);
+			fflush(stdout);
+		}
+		if (batch->last) {
+			drain_pending();
+			ring_push(&checked_ring, n_batch);
+			return NULL;
+		}
+		ring_push(&checked_ring, n_batch);
+		n_forwarded++;
+	}
+}
+
+void *run_formatter_stage(void *unused) 
+{
+	struct link_batch *batch;
+	int i, n_batch, last;
+
+	while (TRUE) {
+		n_batch = ring_take(&checked_ring);
+		batch = &link_batches[n_batch];
+		for(i=0;i<batch->n_links;i++)
+			print_line_result(batch->result[i], batch->line[i], batch->start_node[i], batch->end_node[i]);
+		last = batch->last;
+		if (last)
+			printf("Enter start end:  ");
+		fflush(stdout);
+		ring_push(&free_ring, n_batch);
+		atomic_fetch_add(&batches_printed, 1);
+		if (last)
+			return NULL;
+	}
+}
+
+void print_line_result(int result, long line, int start_node, int end_node) 
+{
+	/* Print what line mode prints for a line, given its result */
+	printf("Enter start end:  ");
+	if (result == BAD_LINE) {
+		printf("input ignored: expected \"start end\" on line %ld\n", line);
+	} else if (result == LONG_LINE) {
+		print_long_line(line);
+	} else if (result == NAMES_FULL) {
+		printf("input ignored: no room for more node names (%d in use)\n", n_symbols);
+		print_result(BAD_DATA);
+	} else if (result == INVALID_LINK) {
+		print_result(check_link(start_node, end_node));
+	} else {
+		print_result(result);
+	}
+}
+
+void start_async() 
+{
+	/* Start the executor, see Async Requests */
+	int fds[2];
+
+	async.quick = engine == &matrix_engine && !budget_rows && !condensing;
+	if (pipe(fds) != 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0 || fcntl(fds[1], F_SETFL, O_NONBLOCK) != 0
+			|| pthread_create(&async.thread, NULL, run_async_executor, NULL) != 0) {
+		perror("cycle_detector: cannot start the async executor");
+		exit(1);
+	}
+	async.event_fd = fds[0];
+	async.wake_fd = fds[1];
+}
+
+void stop_async() 
+{
+	/* Run what is queued, stop the executor and dispatch the last callbacks */
+	while (submit_async(ASYNC_STOP, 0, 0, NULL, NULL, NULL) == ASYNC_BUSY)
+		wait_async();
+	pthread_join(async.thread, NULL);
+	dispatch_async();
+	close(async.event_fd);
+	close(async.wake_fd);
+}
+
+int async_fd() 
+{
+	/* Readable when dispatch_async has callbacks to run */
+	return async.event_fd;
+}
+
+int quick_bit(int n_node, int n_ancestor) 
+{
+	/* is_ancestor for a thread other than the executor, if async.quick */
+	FIELD field = __atomic_load_n(&ancestors[n_node][n_ancestor / FIELD_SIZE], __ATOMIC_RELAXED);
+
+	return n_node == n_ancestor || (field >> (n_ancestor % FIELD_SIZE) & 1);
+}
+
+int async_insert(int start_node, int end_node, async_callback callback, void *context) 
+{
+	/* insert_link on the executor; FAIL or BAD_DATA at once if that is the answer */
+	if (start_node < 0 || start_node >= TOTAL_NODES || end_node < 0 || end_node >= TOTAL_NODES)
+		return BAD_DATA;
+	if (start_node == end_node || (async.quick && quick_bit(start_node, end_node)))
+		return FAIL;
+	return submit_async(ASYNC_INSERT, start_node, end_node, NULL, callback, context);
+}
+
+int async_query(int n_node, int n_ancestor, async_callback callback, void *context) 
+{
+	/* is_ancestor on the executor; TRUE or BAD_DATA at once if that is the answer */
+	if (n_node < 0 || n_node >= TOTAL_NODES || n_ancestor < 0 || n_ancestor >= TOTAL_NODES)
+		return BAD_DATA;
+	if (n_node == n_ancestor || (async.quick && quick_bit(n_node, n_ancestor)))
+		return TRUE;
+	return submit_async(ASYNC_QUERY, n_node, n_ancestor, NULL, callback, context);
+}
+
+int submit_async(int kind, int start_node, int end_node, const char *command,
+								 async_callback callback, void *context) 
+{
+	struct async_request *request;
+
+	pthread_mutex_lock(&async.lock);
+	if (async.n_submitted - async.n_dispatched == ASYNC_SLOTS) {
+		pthread_mutex_unlock(&async.lock);
+		return ASYNC_BUSY;
+	}
+	request = &async.requests[async.n_submitted % ASYNC_SLOTS];
+	request->kind = kind;
+	request->start_node = start_node;
+	request->end_node = end_node;
+	request->command = command;
+	request->callback = callback;
+	request->context = context;
+	async.n_submitted++;
+	pthread_cond_signal(&async.queued);
+	pthread_mutex_unlock(&async.lock);
+	return ASYNC_PENDING;
+}
+
+void *run_async_executor(void *unused) 
+{
+	/* Run the queued requests a pass at a time, see Async Requests */
+	struct async_request *request;
+	unsigned long n, n_end;
+	int stopping = FALSE;
+
+	while (!stopping) {
+		pthread_mutex_lock(&async.lock);
+		while (async.n_done == async.n_submitted)
+			pthread_cond_wait(&async.queued, &async.lock);
+		n_end = async.n_submitted;
+		pthread_mutex_unlock(&async.lock);
+		for(n=async.n_done;n<n_end;n++)
 			{
-				printf("Cycle found\n");
+				request = &async.requests[n % ASYNC_SLOTS];
+				if (request->kind == ASYNC_INSERT) {
+					if (condensing)
+						request->result = insert_link(request->start_node, request->end_node);
+					else
+						request->result = insert_link_deferred(request->start_node, request->end_node);
+				} else if (request->kind == ASYNC_QUERY) {
+					if (condensing)
+						request->result = engine->is_ancestor(request->start_node, request->end_node);
+					else
+						request->result = is_reachable(request->start_node, request->end_node);
+				} else if (request->kind == ASYNC_COMMAND) {
+					run_command((char *)request->command);
+					fflush(stdout);
+					request->result = TRUE;
+				} else {
+					stopping = TRUE;
+				}
 			}
-		if(result == PASS)
-			printf("Good insert\n");
-		if(result == BAD_DATA)
-			printf("Bad (out of bounds) data\n");
+		/* One sweep for every link the pass accepted */
+		drain_pending();
+		pthread_mutex_lock(&async.lock);
+		async.n_done = n_end;
+		pthread_mutex_unlock(&async.lock);
+		/* A full pipe already wakes the event loop */
+		if (write(async.wake_fd, "", 1) != 1 && errno != EAGAIN) {
+			perror("cycle_detector: cannot wake the event loop");
+			exit(1);
+		}
 	}
+	return NULL;
+}
+
+int dispatch_async() 
+{
+	/* Run the callbacks of finished requests; returns how many ran */
+	struct async_request *request;
+	unsigned long n, n_end;
+	char wakes[64];
+
+	/* Empty the pipe first, so a later finish is sure to fill it again */
+	while (read(async.event_fd, wakes, sizeof(wakes)) > 0)
+		;
+	pthread_mutex_lock(&async.lock);
+	n_end = async.n_done;
+	pthread_mutex_unlock(&async.lock);
+	for(n=async.n_dispatched;n<n_end;n++)
+		{
+			request = &async.requests[n % ASYNC_SLOTS];
+			if (request->callback)
+				request->callback(request->result, request->context);
+		}
+	pthread_mutex_lock(&async.lock);
+	n = n_end - async.n_dispatched;
+	async.n_dispatched = n_end;
+	pthread_mutex_unlock(&async.lock);
+	return n;
+}
+
+void wait_async() 
+{
+	/* Wait for the executor to finish something, and dispatch it */
+	struct pollfd wake = { async.event_fd, POLLIN, 0 };
+
+	poll(&wake, 1, -1);
+	dispatch_async();
 }
 
+void run_async_lines(int named) 
+{
+	/* Line mode through async requests, see Async Requests */
+	struct async_line *entry, command;
+	struct pollfd fds[2];
+	char line[LINE_BYTES], start_name[LINE_BYTES], end_name[LINE_BYTES];
+	int result, full;
+
+	start_async();
+	fds[0].fd = async.event_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = 0;
+	fds[1].events = POLLIN;
+	while (TRUE) {
+		full = n_async_read - n_async_printed == ASYNC_SLOTS;
+		if (full || !line_waiting()) {
+			fflush(stdout);
+			fds[1].revents = 0;
+			poll(fds, full ? 1 : 2, -1);
+			if (fds[0].revents) {
+				dispatch_async();
+				print_async_lines();
+			}
+			if (!fds[1].revents)
+				continue;
+		}
+		result = read_line(line, sizeof(line));
+		if (!result)
+			break;
+		if (line[0] == '.') {
+			/* Commands see a quiet executor and every earlier answer printed */
+			while (n_async_printed < n_async_read) {
+				wait_async();
+				print_async_lines();
+			}
+			printf("Enter start end:  ");
+			fflush(stdout);
+			command.result = UNCHECKED;
+			submit_async(ASYNC_COMMAND, 0, 0, line, finish_async_line, &command);
+			while (command.result == UNCHECKED)
+				wait_async();
+			continue;
+		}
+		entry = &async_lines[n_async_read++ % ASYNC_SLOTS];
+		entry->line = input_line;
+		if (result == LONG_LINE) {
+			entry->result = LONG_LINE;
+			print_async_lines();
+			continue;
+		}
+		if (named) {
+			result = sscanf(line, "%255s %255s", start_name, end_name);
+			if (result == 2) {
+				entry->start_node = intern_node(start_name, strlen(start_name));
+				entry->end_node = intern_node(end_name, strlen(end_name));
+				if (entry->start_node == NO_NODE || entry->end_node == NO_NODE)
+					result = NAMES_FULL;
+			}
+		} else {
+			result = parse_pair(line, sizeof(line), &entry->start_node, &entry->end_node);
+		}
+		if (result == EOF)
+			entry->result = BLANK_LINE;
+		else if (result == NAMES_FULL)
+			entry->result = NAMES_FULL;
+		else if (result != 2)
+			entry->result = BAD_LINE;
+		else if (!valid_link(entry->start_node, entry->end_node))
+			entry->result = INVALID_LINK;
+		else
+			entry->result = async_insert(entry->start_node, entry->end_node, finish_async_line, entry);
+		print_async_lines();
+	}
+	while (n_async_printed < n_async_read) {
+		wait_async();
+		print_async_lines();
+	}
+	printf("Enter start end:  ");
+	stop_async();
+	fflush(stdout);
+}
+
+void finish_async_line(int result, void *context) 
+{
+	((struct async_line *)context)->result = result;
+}
+
+void print_async_lines() 
+{
+	/* Print the answered lines at the head of async_lines, in order */
+	struct async_line *entry;
+
+	while (n_async_printed < n_async_read) {
+		entry = &async_lines[n_async_printed % ASYNC_SLOTS];
+		if (entry->result == UNCHECKED)
+			break;
+		print_line_result(entry->result, entry->line, entry->start_node, entry->end_node);
+		n_async_printed++;
+	}
+}
+
+void keep_edge(int start_node, int end_node) 
+{
+	/* Add an accepted link to out_edges, for -E */
+	struct edge_list *list = &out_edges[start_node];
+	unsigned short *old_nodes;
+
+	if (list->count == list->capacity) {
+		old_nodes = list->nodes;
+		list->capacity = list->capacity ? 2 * list->capacity : 4;
+		list->nodes = allocator->allocate(list->capacity * sizeof(unsigned short),
+										sizeof(unsigned short), ANY_NUMA_NODE);
+		if (list->nodes == NULL) {
+			fprintf(stderr, "cycle_detector: out of memory for links\n");
+			exit(1);
+		}
+		if (old_nodes) {
+			memcpy(list->nodes, old_nodes, list->count * sizeof(unsigned short));
+			allocator->release(old_nodes, list->count * sizeof(unsigned short));
+		}
+	}
+	list->nodes[list->count++] = end_node;
+	n_edges++;
+	if (levels_kept)
+		raise_levels(start_node, end_node);
+}
+
+void run_export(char *line) 
+{
+	/* .export what format path, see Exports */
+	char what[16], format[16], *path;
+	FILE *out;
+	int binary, offset = 0, failed;
+	long n_written;
+
+	if (sscanf(line, ".%*s %15s %15s %n", what, format, &offset) != 2 || offset == 0
+			|| (strcmp(what, "closure") != 0 && strcmp(what, "order") != 0 && strcmp(what, "reduction") != 0)
+			|| (strcmp(format, "csv") != 0 && strcmp(format, "binary") != 0)) {
+		printf("input ignored: expected \".export closure|order|reduction csv|binary path\"\n");
+		return;
+	}
+	if (engine != &matrix_engine) {
+		printf("input ignored: .export needs the matrix engine\n");
+		return;
+	}
+	if (strcmp(what, "reduction") == 0 && !edges_kept) {
+		printf("input ignored: .export reduction needs -E\n");
+		return;
+	}
+	path = line + offset;
+	path[strcspn(path, "\r\n")] = '\0';
+	out = path[0] == '|' ? popen(path + 1, "w") : fopen(path, "wb");
+	if (out == NULL) {
+		printf("input ignored: cannot write \"%s\"\n", path);
+		return;
+	}
+	binary = strcmp(format, "binary") == 0;
+	drain_pending();
+	if (what[0] == 'c')
+		n_written = export_closure(out, binary);
+	else if (what[0] == 'o')
+		n_written = export_order_of_nodes(out, binary);
+	else
+		n_written = export_reduction(out, binary);
+	failed = ferror(out);
+	failed |= (path[0] == '|' ? pclose(out) : fclose(out)) != 0;
+	if (failed)
+		printf("export to \"%s\" failed\n", path);
+	else
+		printf("exported %s: %ld %s\n", what, n_written,
+					 what[0] == 'c' ? "rows" : what[0] == 'o' ? "nodes" : "links");
+}
+
+long export_closure(FILE *out, int binary) 
+{
+	/* Write the non-empty rows; returns how many */
+	unsigned char bytes[8];
+	const FIELD *row;
+	int n_node, n_bits, n_runs, n_items, format, i, first, last, bit;
+	long n_rows = 0;
+
+	if (binary) {
+		fwrite("CDCL", 1, 4, out);
+		store_bytes(bytes, EXPORT_VERSION, 4);
+		fwrite(bytes, 1, 4, out);
+	} else {
+		fprintf(out, "node,first,last\n");
+	}
+	for(n_node=0;n_node<TOTAL_NODES;n_node++)
+		{
+			if (ancestor_count[n_node] == 0)
+				continue;
+			n_rows++;
+			if (budget_rows && row_state[n_node] == ROW_PACKED) {
+				export_packed_row(out, n_node, packed_rows[n_node], binary);
+				continue;
+			}
+			row = ancestors[n_node];
+			if (!binary) {
+				for(first=next_in_set(row, 0);first!=NO_NODE;first=bit)
+					{
+						for(last=first;(bit = next_in_set(row, last + 1)) == last + 1;last=bit)
+							;
+						fprintf(out, "%d,%d,%d\n", n_node, first, last);
+					}
+				continue;
+			}
+			count_row_items(row, &n_bits, &n_runs);
+			format = n_bits < 2 * n_runs ? PACKED_BITS : PACKED_RUNS;
+			n_items = format == PACKED_BITS ? n_bits : 2 * n_runs;
+			if (n_items * sizeof(unsigned short) >= ROW_BYTES) {
+				format = EXPORT_RAW;
+				n_items = FIELDS_PER_NODE;
+			}
+			if (format == EXPORT_RAW) {
+				write_export_items(out, n_node, format, n_items, NULL);
+				for(i=0;i<FIELDS_PER_NODE;i++)
+					{
+						store_bytes(bytes, row[i], 8);
+						fwrite(bytes, 1, 8, out);
+					}
+				continue;
+			}
+			row_items(row, format, export_items);
+			write_export_items(out, n_node, format, n_items, export_items);
+		}
+	return n_rows;
+}
+
+void export_packed_row(FILE *out, int n_node, const struct packed_row *packed, int binary) 
+{
+	/* export_closure for a row kept packed, without unpacking it */
+	int step = packed->format == PACKED_RUNS ? 2 : 1;
+	int i, first, last;
+
+	if (binary) {
+		write_export_items(out, n_node, packed->format, packed->n_items, packed->items);
+		return;
+	}
+	for(i=0;i<packed->n_items;)
+		{
+			/* Items of PACKED_BITS may be adjacent; runs never are */
+			first = packed->items[i];
+			last = first;
+			for(;i<packed->n_items && packed->items[i]<=last+1;i+=step)
+				last = step == 2 ? packed->items[i] + packed->items[i + 1] : packed->items[i];
+			fprintf(out, "%d,%d,%d\n", n_node, first, last);
+		}
+}
+
+void write_export_items(FILE *out, int n_node, int format, int n_items, const unsigned short *items) 
+{
+	/* A binary closure row header, then its items unless items is NULL */
+	unsigned char bytes[5];
+	int i;
+
+	store_bytes(bytes, n_node, 2);
+	store_bytes(bytes + 2, format, 1);
+	store_bytes(bytes + 3, n_items, 2);
+	fwrite(bytes, 1, 5, out);
+	for(i=0;i<n_items && items;i++)
+		{
+			store_bytes(bytes, items[i], 2);
+			fwrite(bytes, 1, 2, out);
+		}
+}
+
+long export_order_of_nodes(FILE *out, int binary) 
+{
+	/* Write the linked nodes in a topological order; returns how many */
+	unsigned char bytes[4];
+	int n_node, count, i;
+	long n_nodes = 0;
+
+	/* Counting sort on ancestor_count, stable in node order */
+	memset(export_starts, 0, sizeof(export_starts));
+	for(n_node=0;n_node<TOTAL_NODES;n_node++)
+		{
+			if (ancestor_count[n_node] > 0 || descendant_count[n_node] > 0) {
+				export_starts[ancestor_count[n_node] + 1]++;
+				n_nodes++;
+			}
+		}
+	for(count=0;count<TOTAL_NODES;count++)
+		export_starts[count + 1] += export_starts[count];
+	for(n_node=0;n_node<TOTAL_NODES;n_node++)
+		{
+			if (ancestor_count[n_node] > 0 || descendant_count[n_node] > 0)
+				export_order[export_starts[ancestor_count[n_node]]++] = n_node;
+		}
+
+	if (binary) {
+		fwrite("CDTO", 1, 4, out);
+		store_bytes(bytes, EXPORT_VERSION, 4);
+		fwrite(bytes, 1, 4, out);
+	} else {
+		fprintf(out, "node,ancestors\n");
+	}
+	for(i=0;i<n_nodes;i++)
+		{
+			if (binary) {
+				store_bytes(bytes, export_order[i], 2);
+				fwrite(bytes, 1, 2, out);
+			} else {
+				fprintf(out, "%d,%d\n", export_order[i], ancestor_count[export_order[i]]);
+			}
+		}
+	return n_nodes;
+}
+
+long export_reduction(FILE *out, int binary) 
+{
+	/* Write the stored links no other stored link makes redundant */
+	struct edge_list *list;
+	unsigned char bytes[4];
+	int start_node, i, j, n_kept, redundant;
+	long n_links = 0;
+
+	if (binary) {
+		fwrite("CDTR", 1, 4, out);
+		store_bytes(bytes, EXPORT_VERSION, 4);
+		fwrite(bytes, 1, 4, out);
+	} else {
+		fprintf(out, "start,end\n");
+	}
+	for(start_node=0;start_node<TOTAL_NODES;start_node++)
+		{
+			list = &out_edges[start_node];
+			if (list->count == 0)
+				continue;
+			/* Sort the list and drop repeated links, for good */
+			qsort(list->nodes, list->count, sizeof(unsigned short), compare_nodes);
+			for(i=n_kept=1;i<list->count;i++)
+				{
+					if (list->nodes[i] != list->nodes[n_kept-1])
+						list->nodes[n_kept++] = list->nodes[i];
+				}
+			n_edges -= list->count - n_kept;
+			list->count = n_kept;
+			for(i=0;i<list->count;i++)
+				{
+					redundant = FALSE;
+					for(j=0;j<list->count && !redundant;j++)
+						redundant = j != i && is_ancestor(list->nodes[i], list->nodes[j]);
+					if (redundant)
+						continue;
+					if (binary) {
+						store_bytes(bytes, start_node, 2);
+						store_bytes(bytes + 2, list->nodes[i], 2);
+						fwrite(bytes, 1, 4, out);
+					} else {
+						fprintf(out, "%d,%d\n", start_node, list->nodes[i]);
+					}
+					n_links++;
+				}
+		}
+	return n_links;
+}
+
+int compare_nodes(const void *a, const void *b) 
+{
+	return *(const unsigned short *)a - *(const unsigned short *)b;
+}
+
+void initialize_strong_components() 
+{
+	/* Every node starts out as a strong component of its own */
+	int i;
+	for(i=0;i<TOTAL_NODES;i++)
+		{
+			strong_parent[i] = i;
+			strong_next[i] = i;
+			strong_size[i] = 1;
+		}
+}
+
+int find_strong(int n_node) 
+{
+	/* The representative of n_node's strong component, halving the path */
+	while (strong_parent[n_node] != n_node) {
+		strong_parent[n_node] = strong_parent[strong_parent[n_node]];
+		n_node = strong_parent[n_node];
+	}
+	return n_node;
+}
+
+int insert_link_condensed(int start_node, int end_node) 
+{
+	/* insert_link with -c, between representatives; see Condensation */
+	start_node = find_strong(start_node);
+	end_node = find_strong(end_node);
+	if (start_node == end_node)
+		return MERGED;
+	if (find_component(start_node) == find_component(end_node)
+			&& is_ancestor(start_node,end_node)) {
+		merge_strong_components(start_node,end_node);
+		return MERGED;
+	}
+	insert_ancestors(start_node,end_node);
+	join_components(start_node,end_node);
+	return PASS;
+}
+
+void merge_strong_components(int start_node, int end_node) 
+{
+	/* Fold start_node and the nodes between end_node and it into end_node */
+	FIELD *row = row_of(start_node);
+	int k, next;
+
+	memset(merged_nodes, 0, sizeof(merged_nodes));
+	merged_nodes[start_node / FIELD_SIZE] |= (FIELD)1 << (start_node % FIELD_SIZE);
+	for(k=next_in_set(row, 0);k!=NO_NODE;k=next_in_set(row, k + 1))
+		{
+			if (k != end_node && is_ancestor(k,end_node))
+				merged_nodes[k / FIELD_SIZE] |= (FIELD)1 << (k % FIELD_SIZE);
+		}
+
+	/* Descendants of end_node take start_node's ancestors, but not the merged nodes */
+	k = end_node;
+	do
+		{
+			if (strong_parent[k] == k && !(merged_nodes[k / FIELD_SIZE] >> (k % FIELD_SIZE) & 1)
+					&& is_ancestor(k,end_node)) {
+				or_row(k,start_node);
+				forget_ancestors(k, merged_nodes);
+			}
+			k = component_next[k];
+		} while (k != end_node);
+	/* end_node's own bit came with start_node's row */
+	merged_nodes[end_node / FIELD_SIZE] |= (FIELD)1 << (end_node % FIELD_SIZE);
+	forget_ancestors(end_node, merged_nodes);
+	merged_nodes[end_node / FIELD_SIZE] &= ~((FIELD)1 << (end_node % FIELD_SIZE));
+
+	for(k=next_in_set(merged_nodes, 0);k!=NO_NODE;k=next_in_set(merged_nodes, k + 1))
+		{
+			row = row_of(k);
+			forget_ancestors(k, row);
+			madvise(row, ROW_BYTES, matrix_fd >= 0 ? MADV_REMOVE : MADV_DONTNEED);
+			strong_parent[k] = end_node;
+			next = strong_next[k];
+			strong_next[k] = strong_next[end_node];
+			strong_next[end_node] = next;
+			n_strong -= strong_size[k] > 1;
+			n_strong += strong_size[end_node] == 1;
+			strong_size[end_node] += strong_size[k];
+			n_folded++;
+		}
+	rescan_top_nodes();
+}
+
+void forget_ancestors(int n_node, const FIELD *mask) 
+{
+	/* Clear the ancestors in mask from row n_node, and from the statistics */
+	FIELD *row = writable_row(n_node);
+	FIELD lost;
+	int n_field, n_lost;
+
+	for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+		{
+			lost = row[n_field] & mask[n_field];
+			if (!lost)
+				continue;
+			row[n_field] &= ~lost;
+			n_lost = __builtin_popcountl(lost);
+			ancestor_count[n_node] -= n_lost;
+			reachable_pairs -= n_lost;
+			for(;lost;lost&=lost-1)
+				descendant_count[n_field * FIELD_SIZE + __builtin_ctzl(lost)]--;
+		}
+	rank_valid[n_node] = FALSE;
+}
+
+void rescan_top_nodes() 
+{
+	/* Rebuild the largest counts and top_nodes, after counts have fallen */
+	int i;
+
+	for(i=0;i<n_top;i++)
+		in_top[top_nodes[i]] = FALSE;
+	n_top = 0;
+	max_ancestors = max_descendants = 0;
+	max_ancestors_node = max_descendants_node = 0;
+	for(i=0;i<TOTAL_NODES;i++)
+		{
+			if (ancestor_count[i] == 0 && descendant_count[i] == 0)
+				continue;
+			if (ancestor_count[i] > max_ancestors) {
+				max_ancestors = ancestor_count[i];
+				max_ancestors_node = i;
+			}
+			if (descendant_count[i] > max_descendants) {
+				max_descendants = descendant_count[i];
+				max_descendants_node = i;
+			}
+			update_top_nodes(i);
+		}
+}
+
+void raise_levels(int start_node, int end_node) 
+{
+	/* Lift end_node above start_node, and what follows it as far as need be */
+	struct edge_list *list;
+	int n_stacked = 0, n_node, i, n_next;
+
+	if (node_level[end_node] > node_level[start_node])
+		return;
+	node_level[end_node] = node_level[start_node] + 1;
+	level_stack[n_stacked++] = end_node;
+	level_stacked[end_node] = TRUE;
+	while (n_stacked > 0) {
+		n_node = level_stack[--n_stacked];
+		level_stacked[n_node] = FALSE;
+		level_raises++;
+		if (node_level[n_node] > max_level) {
+			max_level = node_level[n_node];
+			max_level_node = n_node;
+		}
+		list = &out_edges[n_node];
+		for(i=0;i<list->count;i++)
+			{
+				n_next = list->nodes[i];
+				if (node_level[n_next] > node_level[n_node])
+					continue;
+				node_level[n_next] = node_level[n_node] + 1;
+				if (!level_stacked[n_next]) {
+					level_stack[n_stacked++] = n_next;
+					level_stacked[n_next] = TRUE;
+				}
+			}
+	}
+}
+
+void print_level_stats() 
+{
+	if (levels_kept)
+		printf("levels: deepest %d (node %d), %ld levels raised, %ld ancestor tests settled by levels\n",
+					 max_level, max_level_node, level_raises, level_prunes);
+}
+
+void print_level(int n_node) 
+{
+	if (!levels_kept) {
+		printf("input ignored: .level needs -L\n");
+		return;
+	}
+	if (n_node < 0 || n_node >= TOTAL_NODES) {
+		printf("input ignored: node (= %d) must be from 0 to less than TOTAL_NODES (= %d)\n", n_node, TOTAL_NODES);
+		return;
+	}
+	printf("node %d: level %d\n", n_node, node_level[n_node]);
+}
+
+void print_strong_component(int n_node) 
+{
+	int k;
+
+	if (!condensing) {
+		printf("input ignored: .component needs -c\n");
+		return;
+	}
+	if (n_node < 0 || n_node >= TOTAL_NODES) {
+		printf("input ignored: node (= %d) must be from 0 to less than TOTAL_NODES (= %d)\n", n_node, TOTAL_NODES);
+		return;
+	}
+	k = find_strong(n_node);
+	printf("node %d: component of %d, represented by %d:", n_node, strong_size[k], k);
+	n_node = k;
+	do
+		{
+			printf(" %d", k);
+			k = strong_next[k];
+		} while (k != n_node);
+	printf("\n");
+}
+
+void open_link_log(const char *path) 
+{
+	unsigned char header[LOG_HEADER_BYTES];
+
+	link_log = fopen(path, "wb");
+	if (link_log == NULL) {
+		perror("cycle_detector: cannot create the link log");
+		exit(1);
+	}
+	initialize_crc_table();
+	memcpy(header, LOG_MAGIC, 4);
+	store_bytes(header + 4, LOG_VERSION, 4);
+	fwrite(header, 1, sizeof(header), link_log);
+	log_offset = sizeof(header);
+}
+
+void log_link(int start_node, int end_node) 
+{
+	log_links[n_log_links].start = start_node;
+	log_links[n_log_links].end = end_node;
+	if (++n_log_links == LOG_BLOCK_LINKS)
+		write_log_block();
+}
+
+void write_log_block() 
+{
+	/* Sort, encode and write out log_links, see Link Logs */
+	unsigned char header[LOG_BLOCK_HEADER_BYTES], payload[LOG_BLOCK_LINKS * 2 * MAX_VARINT_BYTES];
+	unsigned char *entry;
+	int i, n_bytes = 0, last_start = 0, last_end = 0;
+
+	if (n_log_links == 0)
+		return;
+	qsort(log_links, n_log_links, sizeof(struct link), compare_links);
+	for(i=0;i<n_log_links;i++)
+		{
+			n_bytes += put_varint(payload + n_bytes, log_links[i].start - last_start);
+			if (log_links[i].start != last_start)
+				last_end = 0;
+			n_bytes += put_varint(payload + n_bytes, log_links[i].end - last_end);
+			last_start = log_links[i].start;
+			last_end = log_links[i].end;
+		}
+	store_bytes(header, n_log_links, 4);
+	store_bytes(header + 4, n_bytes, 4);
+	store_bytes(header + 8, crc32_of(payload, n_bytes), 4);
+
+	log_index = realloc(log_index, (n_log_blocks + 1) * LOG_INDEX_ENTRY_BYTES);
+	if (log_index == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory for the link log index\n");
+		exit(1);
+	}
+	entry = log_index + n_log_blocks * LOG_INDEX_ENTRY_BYTES;
+	store_bytes(entry, log_offset, 8);
+	store_bytes(entry + 8, n_log_links, 4);
+	store_bytes(entry + 12, log_links[0].start, 4);
+	n_log_blocks++;
+
+	if (fwrite(header, 1, sizeof(header), link_log) != sizeof(header)
+			|| fwrite(payload, 1, n_bytes, link_log) != n_bytes) {
+		perror("cycle_detector: cannot write the link log");
+		exit(1);
+	}
+	log_offset += sizeof(header) + n_bytes;
+	n_log_links = 0;
+}
+
+void close_link_log() 
+{
+	/* Write the last block, the index and the trailer */
+	unsigned char trailer[LOG_TRAILER_BYTES];
+
+	if (link_log == NULL)
+		return;
+	write_log_block();
+	store_bytes(trailer, log_offset, 8);
+	store_bytes(trailer + 8, n_log_blocks, 4);
+	memcpy(trailer + 12, LOG_INDEX_MAGIC, 4);
+	if (fwrite(log_index, LOG_INDEX_ENTRY_BYTES, n_log_blocks, link_log) != n_log_blocks
+			|| fwrite(trailer, 1, sizeof(trailer), link_log) != sizeof(trailer)
+			|| fclose(link_log) != 0) {
+		perror("cycle_detector: cannot write the link log");
+		exit(1);
+	}
+	link_log = NULL;
+	free(log_index);
+	log_index = NULL;
+}
+
+int compare_links(const void *a, const void *b) 
+{
+	const struct link *x = a, *y = b;
+
+	if (x->start != y->start)
+		return x->start - y->start;
+	return x->end - y->end;
+}
+
+void replay_link_log(const char *path) 
+{
+	/* Insert every link in the log at path, see Link Logs */
+	pthread_t threads[REPLAY_THREADS];
+	struct stat status;
+	const unsigned char *trailer;
+	size_t released = 0;
+	long n_links = 0, n_replayed = 0, n_rejected = 0;
+	int fd, i, k, n_threads, n_damaged = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &status) != 0) {
+		perror("cycle_detector: cannot open the link log");
+		exit(1);
+	}
+	replay.base = MAP_FAILED;
+	if (status.st_size >= LOG_HEADER_BYTES + LOG_TRAILER_BYTES)
+		replay.base = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (replay.base == MAP_FAILED) {
+		fprintf(stderr, "cycle_detector: %s is not a link log\n", path);
+		exit(1);
+	}
+	madvise((void *)replay.base, status.st_size, MADV_SEQUENTIAL);
+	trailer = replay.base + status.st_size - LOG_TRAILER_BYTES;
+	replay.index_offset = load_bytes(trailer, 8);
+	replay.n_blocks = load_bytes(trailer + 8, 4);
+	replay.index = replay.base + replay.index_offset;
+	if (memcmp(replay.base, LOG_MAGIC, 4) != 0 || load_bytes(replay.base + 4, 4) != LOG_VERSION
+			|| memcmp(trailer + 12, LOG_INDEX_MAGIC, 4) != 0 || replay.index_offset < LOG_HEADER_BYTES
+			|| replay.index_offset + (unsigned long long)replay.n_blocks * LOG_INDEX_ENTRY_BYTES
+			!= status.st_size - LOG_TRAILER_BYTES) {
+		fprintf(stderr, "cycle_detector: %s is not a link log\n", path);
+		exit(1);
+	}
+
+	initialize_crc_table();
+	replay.first_link = malloc((replay.n_blocks + 1) * sizeof(long));
+	replay.block_state = calloc(replay.n_blocks + 1, sizeof(*replay.block_state));
+	if (replay.first_link == NULL || replay.block_state == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory to replay %s\n", path);
+		exit(1);
+	}
+	for(k=0;k<replay.n_blocks;k++)
+		{
+			replay.first_link[k] = n_links;
+			n_links += load_bytes(replay.index + k * LOG_INDEX_ENTRY_BYTES + 8, 4);
+		}
+	replay.links = malloc((n_links + 1) * sizeof(struct batch_link));
+	if (replay.links == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory to replay %s\n", path);
+		exit(1);
+	}
+	atomic_store(&replay.next_block, 0);
+	n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n_threads > REPLAY_THREADS)
+		n_threads = REPLAY_THREADS;
+	if (n_threads > replay.n_blocks)
+		n_threads = replay.n_blocks;
+	for(i=0;i<n_threads;i++)
+		{
+			if (pthread_create(&threads[i], NULL, decode_log_blocks, NULL) != 0) {
+				perror("cycle_detector: cannot start replay threads");
+				exit(1);
+			}
+		}
+
+	for(k=0;k<replay.n_blocks;k++)
+		{
+			int n_waits = 0, n_block_links = load_bytes(replay.index + k * LOG_INDEX_ENTRY_BYTES + 8, 4);
+			struct batch_link *links = replay.links + replay.first_link[k];
+
+			while (atomic_load(&replay.block_state[k]) == BLOCK_WAITING)
+				ring_wait(&n_waits);
+			if (atomic_load(&replay.block_state[k]) == BLOCK_DAMAGED) {
+				printf("input ignored: block %d of %s is damaged\n", k, path);
+				n_damaged++;
+				continue;
+			}
+			insert_links_greedy(links, n_block_links);
+			for(i=0;i<n_block_links;i++)
+				{
+					if (links[i].result == PASS)
+						n_replayed++;
+					else
+						n_rejected++;
+				}
+			if (k + 1 < replay.n_blocks)
+				release_pages(replay.base, &released,
+											load_bytes(replay.index + (k + 1) * LOG_INDEX_ENTRY_BYTES, 8));
+		}
+	for(i=0;i<n_threads;i++)
+		pthread_join(threads[i], NULL);
+
+	printf("replayed %ld links from %s", n_replayed, path);
+	if (n_rejected || n_damaged)
+		printf(", %ld rejected, %d damaged blocks", n_rejected, n_damaged);
+	printf("\n");
+	munmap((void *)replay.base, status.st_size);
+	close(fd);
+	free(replay.first_link);
+	free(replay.block_state);
+	free(replay.links);
+}
+
+void *decode_log_blocks(void *unused) 
+{
+	/* A replay thread: decode blocks in order until none are left */
+	int k;
+
+	while ((k = atomic_fetch_add(&replay.next_block, 1)) < replay.n_blocks)
+		atomic_store(&replay.block_state[k], decode_log_block(k) ? BLOCK_DECODED : BLOCK_DAMAGED);
+	return NULL;
+}
+
+int decode_log_block(int n_block) 
+{
+	/* Decode block n_block into replay.links. FALSE if it is damaged. */
+	const unsigned char *entry = replay.index + n_block * LOG_INDEX_ENTRY_BYTES;
+	const unsigned char *header, *bytes, *end;
+	struct batch_link *links = replay.links + replay.first_link[n_block];
+	unsigned long long offset = load_bytes(entry, 8);
+	unsigned int n_links = load_bytes(entry + 8, 4), n_bytes, delta;
+	unsigned int last_start = 0, last_end = 0, i;
+
+	if (offset < LOG_HEADER_BYTES || offset + LOG_BLOCK_HEADER_BYTES > replay.index_offset)
+		return FALSE;
+	header = replay.base + offset;
+	n_bytes = load_bytes(header + 4, 4);
+	bytes = header + LOG_BLOCK_HEADER_BYTES;
+	end = bytes + n_bytes;
+	if (load_bytes(header, 4) != n_links || offset + LOG_BLOCK_HEADER_BYTES + n_bytes > replay.index_offset
+			|| crc32_of(bytes, n_bytes) != load_bytes(header + 8, 4))
+		return FALSE;
+	for(i=0;i<n_links;i++)
+		{
+			n_bytes = get_varint(bytes, end, &delta);
+			bytes += n_bytes;
+			if (delta != 0)
+				last_end = 0;
+			last_start += delta;
+			n_bytes = n_bytes ? get_varint(bytes, end, &delta) : 0;
+			bytes += n_bytes;
+			last_end += delta;
+			if (n_bytes == 0)
+				return FALSE;
+			links[i].start = last_start;
+			links[i].end = last_end;
+			links[i].priority = 0;
+		}
+	return bytes == end;
+}
+
+void ingest_file(const char *path, int deferred) 
+{
+	/* Insert the links in a text file or link log, see Ingestion */
+	pthread_t threads[INGEST_THREADS];
+	struct ingest_slice *slice;
+	struct ingest_line *parsed;
+	struct stat status;
+	char line[LINE_BYTES];
+	size_t released = 0, command;
+	long k, n_line = 0;
+	int fd, i, n_threads, length, n_waits;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &status) != 0) {
+		perror("cycle_detector: cannot open the file to read");
+		exit(1);
+	}
+	if (status.st_size == 0) {
+		close(fd);
+		return;
+	}
+	ingest.size = status.st_size;
+	ingest.base = mmap(NULL, ingest.size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ingest.base == MAP_FAILED) {
+		perror("cycle_detector: cannot map the file to read");
+		exit(1);
+	}
+	if (ingest.size >= 4 && memcmp(ingest.base, LOG_MAGIC, 4) == 0) {
+		munmap((void *)ingest.base, ingest.size);
+		close(fd);
+		replay_link_log(path);
+		return;
+	}
+	madvise((void *)ingest.base, ingest.size, MADV_SEQUENTIAL);
+	ingest.n_slices = (ingest.size + INGEST_SLICE_BYTES - 1) / INGEST_SLICE_BYTES;
+	atomic_store(&ingest.next_slice, 0);
+	atomic_store(&ingest.n_inserted, 0);
+	for(i=0;i<INGEST_WINDOW;i++)
+		atomic_store(&ingest.slices[i].ready, 0);
+	n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n_threads > INGEST_THREADS)
+		n_threads = INGEST_THREADS;
+	if (n_threads > ingest.n_slices)
+		n_threads = ingest.n_slices;
+	for(i=0;i<n_threads;i++)
+		{
+			if (pthread_create(&threads[i], NULL, parse_slices, NULL) != 0) {
+				perror("cycle_detector: cannot start parser threads");
+				exit(1);
+			}
+		}
+
+	for(k=0;k<ingest.n_slices;k++)
+		{
+			slice = &ingest.slices[k % INGEST_WINDOW];
+			for(n_waits=0;atomic_load(&slice->ready) != k + 1;)
+				ring_wait(&n_waits);
+			for(parsed=slice->lines;parsed<slice->lines+slice->n_parsed;parsed++)
+				{
+					if (parsed->result == COMMAND_LINE) {
+						command = slice_boundary(k) + parsed->start_node;
+						for(length=0;length<sizeof(line)-1 && command+length<ingest.size
+									&& ingest.base[command+length]!='\n';length++)
+							line[length] = ingest.base[command + length];
+						line[length] = '\0';
+						run_command(line);
+					} else if (parsed->result == BAD_LINE) {
+						printf("input ignored: expected \"start end\" on line %ld of %s\n",
+									 n_line + parsed->line, path);
+					} else if (parsed->result == LONG_LINE) {
+						printf("input ignored: line %ld of %s is longer than %d characters\n",
+									 n_line + parsed->line, path, LINE_BYTES - 1);
+					} else if (deferred) {
+						print_result(insert_link_deferred(parsed->start_node, parsed->end_node));
+					} else {
+						print_result(insert_link(parsed->start_node, parsed->end_node));
+					}
+				}
+			n_line += slice->n_lines;
+			release_pages(ingest.base, &released, slice_boundary(k + 1));
+			atomic_store(&ingest.n_inserted, k + 1);
+		}
+	fflush(stdout);
+	for(i=0;i<n_threads;i++)
+		pthread_join(threads[i], NULL);
+	for(i=0;i<INGEST_WINDOW;i++)
+		{
+			free(ingest.slices[i].lines);
+			ingest.slices[i].lines = NULL;
+			ingest.slices[i].n_allocated = 0;
+		}
+	munmap((void *)ingest.base, ingest.size);
+	close(fd);
+}
+
+void *parse_slices(void *unused) 
+{
+	/* A parser thread: take slices in order, staying inside the window */
+	long k;
+	int n_waits;
+
+	while ((k = atomic_fetch_add(&ingest.next_slice, 1)) < ingest.n_slices) {
+		for(n_waits=0;k>=atomic_load(&ingest.n_inserted)+INGEST_WINDOW;)
+			ring_wait(&n_waits);
+		parse_slice(&ingest.slices[k % INGEST_WINDOW], k);
+		atomic_store(&ingest.slices[k % INGEST_WINDOW].ready, k + 1);
+	}
+	return NULL;
+}
+
+void parse_slice(struct ingest_slice *slice, long n_slice) 
+{
+	const char *slice_start = ingest.base + slice_boundary(n_slice);
+	const char *end = ingest.base + slice_boundary(n_slice + 1);
+	const char *at = slice_start;
+	const char *newline;
+	struct ingest_line *parsed;
+	char line[LINE_BYTES];
+	int length, fields;
+
+	slice->n_lines = 0;
+	slice->n_parsed = 0;
+	for(;at<end;at=newline+1)
+		{
+			newline = memchr(at, '\n', end - at);
+			if (newline == NULL)
+				newline = end;
+			slice->n_lines++;
+			if (slice->n_parsed == slice->n_allocated) {
+				slice->n_allocated = slice->n_allocated ? 2 * slice->n_allocated : 65536;
+				slice->lines = realloc(slice->lines, slice->n_allocated * sizeof(struct ingest_line));
+				if (slice->lines == NULL) {
+					fprintf(stderr, "cycle_detector: out of memory for %d parsed lines\n", slice->n_allocated);
+					exit(1);
+				}
+			}
+			parsed = &slice->lines[slice->n_parsed];
+			parsed->line = slice->n_lines;
+			if (newline - at > sizeof(line) - 1) {
+				parsed->result = LONG_LINE;
+				slice->n_parsed++;
+				continue;
+			}
+			if (*at == '.') {
+				parsed->result = COMMAND_LINE;
+				parsed->start_node = at - slice_start;
+				slice->n_parsed++;
+				continue;
+			}
+			if (scan_pair(at, ingest.base + ingest.size - at, &parsed->start_node, &parsed->end_node)) {
+				parsed->result = UNCHECKED;
+				slice->n_parsed++;
+				continue;
+			}
+			length = newline - at;
+			memcpy(line, at, length);
+			line[length] = '\0';
+			fields = sscanf(line, "%d %d", &parsed->start_node, &parsed->end_node);
+			if (fields == EOF)
+				continue;
+			parsed->result = fields == 2 ? UNCHECKED : BAD_LINE;
+			slice->n_parsed++;
+		}
+}
+
+long slice_boundary(long n_slice) 
+{
+	/* Where slice n_slice starts: just after a newline, see Ingestion */
+	const char *newline;
+	long nominal = n_slice * INGEST_SLICE_BYTES;
+
+	if (n_slice == 0)
+		return 0;
+	if (n_slice >= ingest.n_slices)
+		return ingest.size;
+	newline = memchr(ingest.base + nominal - 1, '\n', ingest.size - nominal + 1);
+	return newline ? newline + 1 - ingest.base : ingest.size;
+}
+
+void release_pages(const void *base, size_t *released, size_t upto) 
+{
+	/* Give back the whole pages of a mapping from *released to upto */
+	size_t page = sysconf(_SC_PAGESIZE);
+
+	upto -= upto % page;
+	if (upto > *released) {
+		madvise((char *)base + *released, upto - *released, MADV_DONTNEED);
+		*released = upto;
+	}
+}
+
+void initialize_crc_table() 
+{
+	/* CRC-32 as in zlib, reflected polynomial 0xedb88320 */
+	unsigned int c;
+	int i, k;
+
+	for(i=0;i<256;i++)
+		{
+			c = i;
+			for(k=0;k<8;k++)
+				c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			crc_table[i] = c;
+		}
+}
+
+unsigned int crc32_of(const unsigned char *bytes, size_t n_bytes) 
+{
+	unsigned int crc = 0xffffffff;
+
+	while (n_bytes--)
+		crc = crc_table[(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffff;
+}
+
+int put_varint(unsigned char *bytes, unsigned int value) 
+{
+	int n_bytes = 0;
+
+	while (value >= 0x80) {
+		bytes[n_bytes++] = value | 0x80;
+		value >>= 7;
+	}
+	bytes[n_bytes++] = value;
+	return n_bytes;
+}
+
+int get_varint(const unsigned char *bytes, const unsigned char *end, unsigned int *value) 
+{
+	/* Returns the bytes used, or 0 if the varint is cut off or too long */
+	int n_bytes = 0;
+
+	*value = 0;
+	while (bytes + n_bytes < end && n_bytes < MAX_VARINT_BYTES) {
+		*value |= (unsigned int)(bytes[n_bytes] & 0x7f) << (7 * n_bytes);
+		if ((bytes[n_bytes++] & 0x80) == 0)
+			return n_bytes;
+	}
+	return 0;
+}
+
+void store_bytes(unsigned char *bytes, unsigned long long value, int n_bytes) 
+{
+	/* Little-endian */
+	int i;
+
+	for(i=0;i<n_bytes;i++)
+		bytes[i] = value >> (8 * i);
+}
+
+unsigned long long load_bytes(const unsigned char *bytes, int n_bytes) 
+{
+	unsigned long long value = 0;
+	int i;
+
+	for(i=0;i<n_bytes;i++)
+		value |= (unsigned long long)bytes[i] << (8 * i);
+	return value;
+}
+
+void initialize_components() 
+{
+	/* Every node starts out as a component of its own */
+	int i;
+	for(i=0;i<TOTAL_NODES;i++)
+		{
+			component_parent[i] = i;
+			component_next[i] = i;
+			component_low[i] = i;
+			component_high[i] = i;
+			component_size[i] = 1;
+		}
+}
+
+int find_component(int n_node) 
+{
+	/* Union-find root of n_node's component, halving the path on the way */
+	while (component_parent[n_node] != n_node) {
+		component_parent[n_node] = component_parent[component_parent[n_node]];
+		n_node = component_parent[n_node];
+	}
+	return n_node;
+}
+
+void join_components(int n_node, int n_other) 
+{
+	int root = find_component(n_node);
+	int other = find_component(n_other);
+	unsigned short next;
+
+	if (root == other)
+		return;
+	linked_nodes += (component_size[root] == 1) + (component_size[other] == 1);
+	if (component_size[root] < component_size[other]) {
+		other = root;
+		root = find_component(n_other);
+	}
+	component_parent[other] = root;
+	component_size[root] += component_size[other];
+	if (component_low[other] < component_low[root])
+		component_low[root] = component_low[other];
+	if (component_high[other] > component_high[root])
+		component_high[root] = component_high[other];
+	/* Splice the two circular member lists into one */
+	next = component_next[root];
+	component_next[root] = component_next[other];
+	component_next[other] = next;
+}
+
+int is_ancestor(int n_node, int n_ancestor) 
+{
+	int n_target_chunk = n_ancestor / FIELD_SIZE;
+	int n_target_bit = n_ancestor % FIELD_SIZE;
+	FIELD bit_to_get = (FIELD)1 << n_target_bit;
+
+	/* By definition all self links (x->x) are closing links. */
+	if(n_node == n_ancestor)
+		return(TRUE);
+	if (levels_kept && node_level[n_ancestor] >= node_level[n_node]) {
+		level_prunes++;
+		return(FALSE);
+	}
+	if (budget_rows && row_state[n_node] == ROW_PACKED)
+		return packed_has_bit(n_node, n_ancestor);
+	if(row_of(n_node)[n_target_chunk] & bit_to_get)
+		return(TRUE);
+	else 
+		return(FALSE);
+}
+
+void set_ancestor(int n_descendant, int n_ancestor) 
+{
+	int n_target_chunk = n_ancestor / FIELD_SIZE;
+	int n_target_bit  = n_ancestor % FIELD_SIZE;
+	FIELD bit_to_set = (FIELD)1 << n_target_bit;
+
+	writable_row(n_descendant)[n_target_chunk] |= bit_to_set;
+	rank_valid[n_descendant] = FALSE;
+
+	return;
+}
+
+unsigned short *rank_directory(int n_node) 
+{
+	/* Row n_node's directory, rebuilt if stale; see Rank and Select */
+	unsigned short *directory = rank_directories[n_node];
+	FIELD *row;
+	int n_block, i, n_ones = 0;
+
+	if (rank_valid[n_node])
+		return directory;
+	if (directory == NULL) {
+		directory = rank_directories[n_node] = allocator->allocate(RANK_BLOCKS * sizeof(unsigned short),
+												sizeof(FIELD), ANY_NUMA_NODE);
+		if (directory == NULL) {
+			fprintf(stderr, "cycle_detector: out of memory for rank directories\n");
+			exit(1);
+		}
+	}
+	row = row_of(n_node);
+	for(n_block=0;n_block<RANK_BLOCKS;n_block++)
+		{
+			directory[n_block] = n_ones;
+			for(i=0;i<RANK_BLOCK_FIELDS;i++)
+				n_ones += __builtin_popcountl(row[n_block * RANK_BLOCK_FIELDS + i]);
+		}
+	rank_valid[n_node] = TRUE;
+	return directory;
+}
+
+int row_rank(int n_node, int bit) 
+{
+	/* The number of ancestors of n_node numbered below bit */
+	unsigned short *directory = rank_directory(n_node);
+	FIELD *row = row_of(n_node);
+	int n_block, n_field, n_ones;
+
+	if (bit > TOTAL_NODES)
+		bit = TOTAL_NODES;
+	n_block = bit < TOTAL_NODES ? bit / RANK_BLOCK_BITS : RANK_BLOCKS - 1;
+	n_ones = directory[n_block];
+	for(n_field=n_block*RANK_BLOCK_FIELDS;n_field<bit/FIELD_SIZE;n_field++)
+		n_ones += __builtin_popcountl(row[n_field]);
+	if (bit % FIELD_SIZE)
+		n_ones += __builtin_popcountl(row[bit / FIELD_SIZE] << (FIELD_SIZE - bit % FIELD_SIZE));
+	return n_ones;
+}
+
+int row_range_count(int n_node, int low, int high) 
+{
+	/* The number of ancestors of n_node from low to less than high */
+	if (high <= low)
+		return 0;
+	return row_rank(n_node, high) - row_rank(n_node, low);
+}
+
+int row_select(int n_node, int k) 
+{
+	/* The k-th ancestor of n_node, from 0, or NO_NODE if there are fewer */
+	unsigned short *directory = rank_directory(n_node);
+	FIELD *row = row_of(n_node);
+	FIELD field;
+	int low = 0, high = RANK_BLOCKS - 1, middle, n_field, n_ones;
+
+	if (k < 0)
+		return NO_NODE;
+	/* The last block with fewer than k + 1 ancestors before it */
+	while (low < high) {
+		middle = (low + high + 1) / 2;
+		if (directory[middle] <= k)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+	k -= directory[low];
+	for(n_field=low*RANK_BLOCK_FIELDS;n_field<(low+1)*RANK_BLOCK_FIELDS;n_field++)
+		{
+			n_ones = __builtin_popcountl(row[n_field]);
+			if (k < n_ones) {
+				for(field=row[n_field];k>0;k--)
+					field &= field - 1;
+				return n_field * FIELD_SIZE + __builtin_ctzl(field);
+			}
+			k -= n_ones;
+		}
+	return NO_NODE;
+}
+
+FIELD *row_of(int n_node) 
+{
+	/* Row n_node of the matrix, unpacked if need be; see Memory Budget */
+	if (budget_rows == 0)
+		return ancestors[n_node];
+	row_accesses++;
+	row_referenced[n_node] = TRUE;
+	if (last_rows[0] != n_node) {
+		last_rows[1] = last_rows[0];
+		last_rows[0] = n_node;
+	}
+	if (row_state[n_node] == ROW_PACKED) {
+		packed_hits++;
+		unpack_row(n_node);
+		add_to_clock(n_node);
+	}
+	return ancestors[n_node];
+}
+
+FIELD *writable_row(int n_node) 
+{
+	/* row_of, for a row about to be written */
+	FIELD *row = row_of(n_node);
+
+	if (budget_rows && row_state[n_node] == ROW_UNTOUCHED)
+		add_to_clock(n_node);
+	return row;
+}
+
+void add_to_clock(int n_node) 
+{
+	row_state[n_node] = ROW_UNPACKED;
+	clock_slot[n_node] = n_clock_rows;
+	clock_rows[n_clock_rows++] = n_node;
+	enforce_row_budget();
+}
+
+void enforce_row_budget() 
+{
+	/* Pack unreferenced rows until the budget holds, see Memory Budget */
+	int k, n_visited;
+
+	for(n_visited=0;n_clock_rows>budget_rows && n_visited<2*n_clock_rows;n_visited++)
+		{
+			if (clock_hand >= n_clock_rows)
+				clock_hand = 0;
+			k = clock_rows[clock_hand];
+			if (k == last_rows[0] || k == last_rows[1] || row_referenced[k]) {
+				row_referenced[k] = FALSE;
+				clock_hand++;
+				continue;
+			}
+			if (pack_row(k)) {
+				/* The last row in clock_rows takes its slot */
+				n_clock_rows--;
+				clock_rows[clock_hand] = clock_rows[n_clock_rows];
+				clock_slot[clock_rows[clock_hand]] = clock_hand;
+			} else {
+				clock_hand++;
+			}
+		}
+}
+
+int pack_row(int n_node) 
+{
+	/* Replace row n_node by a packed_row. FALSE if it would not be smaller. */
+	FIELD *row = ancestors[n_node];
+	struct packed_row *packed;
+	int n_bits, n_runs, n_items;
+
+	count_row_items(row, &n_bits, &n_runs);
+	n_items = n_bits < 2 * n_runs ? n_bits : 2 * n_runs;
+	if (n_items * sizeof(unsigned short) + sizeof(struct packed_row) >= ROW_BYTES)
+		return FALSE;
+	packed = allocator->allocate(sizeof(struct packed_row) + n_items * sizeof(unsigned short),
+								sizeof(int), ANY_NUMA_NODE);
+	if (packed == NULL)
+		return FALSE;
+	packed->format = n_bits < 2 * n_runs ? PACKED_BITS : PACKED_RUNS;
+	packed->n_items = row_items(row, packed->format, packed->items);
+	packed_rows[n_node] = packed;
+	row_state[n_node] = ROW_PACKED;
+	n_packed_rows++;
+	packed_bytes += sizeof(struct packed_row) + n_items * sizeof(unsigned short);
+	/* A shared matrix keeps its pages in the memfd unless they are removed */
+	madvise(row, ROW_BYTES, matrix_fd >= 0 ? MADV_REMOVE : MADV_DONTNEED);
+	return TRUE;
+}
+
+void count_row_items(const FIELD *row, int *n_bits, int *n_runs) 
+{
+	/* The items row would take as PACKED_BITS, and the runs in it */
+	FIELD starts;
+	int n_field;
+
+	*n_bits = *n_runs = 0;
+	for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+		{
+			/* A run starts at a 1 whose lower neighbour, maybe in the last FIELD, is 0 */
+			starts = row[n_field] & ~(row[n_field] << 1 | (n_field ? row[n_field-1] >> (FIELD_SIZE-1) : 0));
+			*n_bits += __builtin_popcountl(row[n_field]);
+			*n_runs += __builtin_popcountl(starts);
+		}
+}
+
+int row_items(const FIELD *row, int format, unsigned short *items) 
+{
+	/* Write row into items in a packed_row format; returns the item count */
+	FIELD bits;
+	int n_field, n_items = 0, bit, last = -2;
+
+	for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+		{
+			for(bits=row[n_field];bits;bits&=bits-1)
+				{
+					bit = n_field * FIELD_SIZE + __builtin_ctzl(bits);
+					if (format == PACKED_BITS) {
+						items[n_items++] = bit;
+					} else if (bit == last + 1) {
+						items[n_items - 1]++;
+					} else {
+						items[n_items++] = bit;
+						items[n_items++] = 0;
+					}
+					last = bit;
+				}
+		}
+	return n_items;
+}
+
+void unpack_row(int n_node) 
+{
+	FIELD *row = ancestors[n_node];
+	struct packed_row *packed = packed_rows[n_node];
+	int i, bit, last;
+
+	memset(row, 0, ROW_BYTES);
+	for(i=0;i<packed->n_items;i++)
+		{
+			bit = packed->items[i];
+			last = packed->format == PACKED_RUNS ? bit + packed->items[++i] : bit;
+			for(;bit<=last;bit++)
+				row[bit / FIELD_SIZE] |= (FIELD)1 << (bit % FIELD_SIZE);
+		}
+	packed_bytes -= sizeof(struct packed_row) + packed->n_items * sizeof(unsigned short);
+	n_packed_rows--;
+	allocator->release(packed, sizeof(struct packed_row) + packed->n_items * sizeof(unsigned short));
+	packed_rows[n_node] = NULL;
+}
+
+int packed_has_bit(int n_node, int bit) 
+{
+	/* Read a bit of a packed row without unpacking it */
+	struct packed_row *packed = packed_rows[n_node];
+	int step = packed->format == PACKED_RUNS ? 2 : 1;
+	int low = 0, high = packed->n_items / step - 1, middle;
+
+	row_accesses++;
+	packed_hits++;
+	/* Find the last item starting at or before bit */
+	while (low <= high) {
+		middle = (low + high) / 2;
+		if (packed->items[middle * step] <= bit)
+			low = middle + 1;
+		else
+			high = middle - 1;
+	}
+	if (high < 0)
+		return FALSE;
+	if (step == 1)
+		return packed->items[high] == bit;
+	return bit <= packed->items[2 * high] + packed->items[2 * high + 1];
+}
+
+void unpack_all_rows() 
+{
+	/* Lift the budget, for a handover */
+	int k;
+
+	for(k=0;k<TOTAL_NODES;k++)
+		{
+			if (row_state[k] == ROW_PACKED) {
+				unpack_row(k);
+				row_state[k] = ROW_UNPACKED;
+			}
+		}
+	budget_rows = 0;
+}
+
+int bloom_is_ancestor(int n_node, int n_ancestor) 
+{
+	/* TRUE if n_ancestor may be an ancestor; never FALSE when it is one */
+	int n_field;
+	FIELD mask;
+
+	if (n_node == n_ancestor)
+		return(TRUE);
+	if (levels_kept && node_level[n_ancestor] >= node_level[n_node]) {
+		level_prunes++;
+		return(FALSE);
+	}
+	if (find_component(n_node) != find_component(n_ancestor))
+		return(FALSE);
+	bloom_key(n_ancestor, &n_field, &mask);
+	return (bloom_rows[n_node][n_field] & mask) == mask;
+}
+
+void bloom_insert_ancestors(int start_node, int end_node) 
+{
+	/* insert_ancestors with Bloom filters for rows */
+	int k = end_node;
+
+	do
+		{
+			if (bloom_is_ancestor(k,end_node))
+				bloom_or_row(k,start_node);
+			k = component_next[k];
+		} while (k != end_node);
+}
+
+void bloom_or_row(int n_descendant, int n_source) 
+{
+	/* bloom_rows[n_descendant] |= bloom_rows[n_source] plus n_source itself */
+	FIELD *row = bloom_rows[n_descendant];
+	FIELD mask;
+	int n_field, n_ones = 0;
+	double fill;
+
+	bloom_key(n_source, &n_field, &mask);
+	row[n_field] |= mask;
+	for(n_field=0;n_field<bloom_fields;n_field++)
+		{
+			row[n_field] |= bloom_rows[n_source][n_field];
+			n_ones += __builtin_popcountl(row[n_field]);
+		}
+	if (n_ones != bloom_ones[n_descendant]) {
+		fill = (double)bloom_ones[n_descendant] / (bloom_fields * FIELD_SIZE);
+		bloom_fill_sum -= pow(fill, bloom_hashes);
+		fill = (double)n_ones / (bloom_fields * FIELD_SIZE);
+		bloom_fill_sum += pow(fill, bloom_hashes);
+		bloom_ones[n_descendant] = n_ones;
+	}
+}
+
+void bloom_key(int n_ancestor, int *n_field, FIELD *mask) 
+{
+	/*
+		The FIELD of a row holding n_ancestor, and the bloom_hashes bits set in it.
+		The bits come from successive 6 bit slices of a 64 bit mix of n_ancestor.
+	*/
+	unsigned long long hash = mix_node(n_ancestor);
+	int i;
+
+	*n_field = (hash >> 48) % bloom_fields;
+	*mask = 0;
+	for(i=0;i<bloom_hashes;i++)
+		{
+			*mask |= (FIELD)1 << (hash % FIELD_SIZE);
+			hash /= FIELD_SIZE;
+		}
+}
+
+unsigned long long mix_node(int n_node) 
+{
+	/* 64 well mixed bits from a node number (the splitmix64 finalizer) */
+	unsigned long long hash = (unsigned long long)n_node + 0x9E3779B97F4A7C15ULL;
+
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+double bloom_false_positive_rate() 
+{
+	/* Estimated from the filter fill, averaged over linked nodes */
+	return linked_nodes ? bloom_fill_sum / linked_nodes : 0;
+}
+
+void sketch_link(int start_node, int end_node) 
+{
+	/* Merge sketches along the walk insert_ancestors takes, see Sketches */
+	FIELD *start_sketch = sketch_of(&ancestor_sketch[start_node]);
+	FIELD *end_sketch = sketch_of(&descendant_sketch[end_node]);
+	FIELD *sketch;
+	int k = end_node;
+
+	do
+		{
+			if (engine->is_ancestor(k,end_node)) {
+				sketch = sketch_of(&ancestor_sketch[k]);
+				merge_sketch(sketch, start_sketch);
+				add_to_sketch(sketch, start_node);
+			}
+			k = component_next[k];
+		} while (k != end_node);
+	k = start_node;
+	do
+		{
+			if (engine->is_ancestor(start_node,k)) {
+				sketch = sketch_of(&descendant_sketch[k]);
+				merge_sketch(sketch, end_sketch);
+				add_to_sketch(sketch, end_node);
+			}
+			k = component_next[k];
+		} while (k != start_node);
+}
+
+FIELD *sketch_of(FIELD **sketch) 
+{
+	/* The sketch at *sketch, allocated empty if need be */
+	if (*sketch == NULL) {
+		*sketch = allocator->allocate(SKETCH_FIELDS * sizeof(FIELD), sizeof(FIELD), ANY_NUMA_NODE);
+		if (*sketch == NULL) {
+			fprintf(stderr, "cycle_detector: out of memory for sketches\n");
+			exit(1);
+		}
+	}
+	return *sketch;
+}
+
+void add_to_sketch(FIELD *sketch, int n_node) 
+{
+	/*
+		The low HLL_BITS of the hash pick a register. The register keeps the
+		highest rank seen, the rank being one more than the number of trailing
+		zeros in the rest of the hash, capped at 15 to fit in 4 bits.
+	*/
+	unsigned long long hash = mix_node(n_node);
+	int n_register = hash & (HLL_REGISTERS - 1);
+	int shift = (n_register % (FIELD_SIZE/4)) * 4;
+	FIELD *field = &sketch[n_register / (FIELD_SIZE/4)];
+	FIELD rank;
+
+	hash >>= HLL_BITS;
+	rank = hash ? __builtin_ctzll(hash) + 1 : 15;
+	if (rank > 15)
+		rank = 15;
+	if (rank > ((*field >> shift) & 0xF))
+		*field = (*field & ~((FIELD)0xF << shift)) | rank << shift;
+}
+
+void merge_sketch(FIELD *sketch, FIELD *other) 
+{
+	/* sketch = register-wise maximum of sketch and other */
+	int n_field;
+
+	for(n_field=0;n_field<SKETCH_FIELDS;n_field++)
+		sketch[n_field] = max_registers(sketch[n_field], other[n_field]);
+}
+
+FIELD max_registers(FIELD x, FIELD y) 
+{
+	/*
+		Maximum of each pair of 4 bit registers in x and y. The even and odd
+		registers are handled separately so each sits in the low half of a byte.
+		Then (x | 0x10) - y leaves bit 4 of a byte set exactly where x >= y, and
+		no borrow crosses into the next byte.
+	*/
+	FIELD low = (FIELD)~0 / 0xFF * 0x0F;  /* 0x0F in every byte */
+	FIELD bit4 = (FIELD)~0 / 0xFF * 0x10;
+	FIELD result = 0, x_part, y_part, x_wins;
+	int shift;
+
+	for(shift=0;shift<8;shift+=4)
+		{
+			x_part = (x >> shift) & low;
+			y_part = (y >> shift) & low;
+			x_wins = ((((x_part | bit4) - y_part) & bit4) >> 4) * 0x0F;
+			result |= ((x_part & x_wins) | (y_part & ~x_wins & low)) << shift;
+		}
+	return result;
+}
+
+double estimate_sketch(FIELD *sketch) 
+{
+	/* HyperLogLog estimate, with linear counting for small sets */
+	double sum = 0, estimate;
+	int n_register, n_zero = 0, rank;
+
+	if (sketch == NULL)
+		return 0;
+	for(n_register=0;n_register<HLL_REGISTERS;n_register++)
+		{
+			rank = (sketch[n_register / (FIELD_SIZE/4)] >> (n_register % (FIELD_SIZE/4)) * 4) & 0xF;
+			sum += ldexp(1.0, -rank);
+			n_zero += rank == 0;
+		}
+	estimate = 0.7213 / (1 + 1.079 / HLL_REGISTERS) * HLL_REGISTERS * HLL_REGISTERS / sum;
+	if (estimate <= 2.5 * HLL_REGISTERS && n_zero > 0)
+		estimate = HLL_REGISTERS * log((double)HLL_REGISTERS / n_zero);
+	return estimate;
+}
+
+void print_counts(int n_node) 
+{
+	if (n_node < 0 || n_node >= TOTAL_NODES) {
+		printf("input ignored: node (= %d) must be from 0 to less than TOTAL_NODES (= %d)\n", n_node, TOTAL_NODES);
+		return;
+	}
+	drain_pending();
+	if (sketches)
+		printf("node %d: about %.0f ancestors, %.0f descendants\n", n_node,
+					 estimate_sketch(ancestor_sketch[n_node]), estimate_sketch(descendant_sketch[n_node]));
+	if (engine != &bloom_engine)
+		printf("node %d: %d ancestors, %d descendants\n", n_node,
+					 ancestor_count[n_node], descendant_count[n_node]);
+}
+
+void ancestor_set(int n_node, FIELD *set) 
+{
+	/* The ancestors of n_node, itself included, see Set Queries */
+	FIELD *row;
+	int k;
+
+	if (engine == &matrix_engine) {
+		row = row_of(n_node);
+		memcpy(set, row, ROW_BYTES);
+	} else {
+		memset(set, 0, ROW_BYTES);
+		k = n_node;
+		do
+			{
+				if (engine->is_ancestor(n_node, k))
+					set[k / FIELD_SIZE] |= (FIELD)1 << (k % FIELD_SIZE);
+				k = component_next[k];
+			} while (k != n_node);
+	}
+	set[n_node / FIELD_SIZE] |= (FIELD)1 << (n_node % FIELD_SIZE);
+}
+
+void common_ancestors(const int *nodes, int n_nodes, FIELD *set) 
+{
+	/* set = the nodes that are ancestors of every one of nodes */
+	FIELD other[FIELDS_PER_NODE];
+	int i, n_field;
+
+	ancestor_set(nodes[0], set);
+	for(i=1;i<n_nodes;i++)
+		{
+			ancestor_set(nodes[i], other);
+			for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+				set[n_field] &= other[n_field];
+		}
+}
+
+void any_ancestors(const int *nodes, int n_nodes, FIELD *set) 
+{
+	/* set = the nodes that are ancestors of at least one of nodes */
+	FIELD other[FIELDS_PER_NODE];
+	int i, n_field;
+
+	memset(set, 0, ROW_BYTES);
+	for(i=0;i<n_nodes;i++)
+		{
+			ancestor_set(nodes[i], other);
+			for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+				set[n_field] |= other[n_field];
+		}
+}
+
+void subtract_ancestors(const int *nodes, int n_nodes, FIELD *set) 
+{
+	/* Remove from set the ancestors of each of nodes */
+	FIELD other[FIELDS_PER_NODE];
+	int i, n_field;
+
+	for(i=0;i<n_nodes;i++)
+		{
+			ancestor_set(nodes[i], other);
+			for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+				set[n_field] &= ~other[n_field];
+		}
+}
+
+void reachable_from(const int *nodes, int n_nodes, FIELD *set) 
+{
+	/* set = the nodes with at least one of nodes as an ancestor, see Set Queries */
+	FIELD mask[FIELDS_PER_NODE], *row, any;
+	int i, j, k, root, n_field, n_last;
+
+	memset(mask, 0, ROW_BYTES);
+	for(i=0;i<n_nodes;i++)
+		mask[nodes[i] / FIELD_SIZE] |= (FIELD)1 << (nodes[i] % FIELD_SIZE);
+	memcpy(set, mask, ROW_BYTES);
+	for(i=0;i<n_nodes;i++)
+		{
+			/* Scan each component holding some of nodes once */
+			root = find_component(nodes[i]);
+			for(j=0;j<i && find_component(nodes[j])!=root;j++)
+				;
+			if (j < i)
+				continue;
+			n_last = component_high[root] / FIELD_SIZE;
+			k = root;
+			do
+				{
+					if (engine == &matrix_engine && !(budget_rows && row_state[k] == ROW_PACKED)) {
+						row = row_of(k);
+						any = 0;
+						for(n_field=component_low[root]/FIELD_SIZE;n_field<=n_last;n_field++)
+							any |= row[n_field] & mask[n_field];
+					} else {
+						for(j=0,any=0;j<n_nodes && !any;j++)
+							any = find_component(nodes[j]) == root && engine->is_ancestor(k, nodes[j]);
+					}
+					if (any)
+						set[k / FIELD_SIZE] |= (FIELD)1 << (k % FIELD_SIZE);
+					k = component_next[k];
+				} while (k != root);
+		}
+}
+
+int next_in_set(const FIELD *set, int n_node) 
+{
+	/* The first member of set from n_node on, or NO_NODE */
+	int n_field = n_node / FIELD_SIZE;
+	FIELD rest;
+
+	if (n_node >= TOTAL_NODES)
+		return NO_NODE;
+	rest = set[n_field] & (~(FIELD)0 << (n_node % FIELD_SIZE));
+	while (rest == 0) {
+		if (++n_field == FIELDS_PER_NODE)
+			return NO_NODE;
+		rest = set[n_field];
+	}
+	return n_field * FIELD_SIZE + __builtin_ctzl(rest);
+}
+
+void run_set_query(char *command, char *line) 
+{
+	/* .common, .ancestors and .reach, see Set Queries */
+	FIELD set[FIELDS_PER_NODE], excluded[FIELDS_PER_NODE];
+	int nodes[128], n_nodes = 0, n_included = -1, n_members = 0;
+	int k, n_read, n_field;
+	char *at = line, token[32];
+
+	if (engine == &bloom_engine) {
+		printf("input ignored: .%s needs an exact engine\n", command);
+		return;
+	}
+	/* Skip the command, then read nodes, with "-" before those left out */
+	sscanf(at, "%31s%n", token, &n_read);
+	at += n_read;
+	while (sscanf(at, "%31s%n", token, &n_read) == 1) {
+		at += n_read;
+		if (strcmp(token, "-") == 0 && n_included < 0) {
+			n_included = n_nodes;
+			continue;
+		}
+		if (n_nodes == sizeof(nodes) / sizeof(nodes[0])
+				|| sscanf(token, "%d", &nodes[n_nodes]) != 1 || nodes[n_nodes] < 0 || nodes[n_nodes] >= TOTAL_NODES) {
+			printf("input ignored: expected \".%s n ... [- m ...]\" with nodes from 0 to less than TOTAL_NODES (= %d)\n",
+						 command, TOTAL_NODES);
+			return;
+		}
+		n_nodes++;
+	}
+	if (n_included < 0)
+		n_included = n_nodes;
+	if (n_included == 0) {
+		printf("input ignored: .%s needs at least one node\n", command);
+		return;
+	}
+	drain_pending();
+	if (strcmp(command, "reach") == 0) {
+		reachable_from(nodes, n_included, set);
+		if (n_nodes > n_included) {
+			reachable_from(nodes + n_included, n_nodes - n_included, excluded);
+			for(n_field=0;n_field<FIELDS_PER_NODE;n_field++)
+				set[n_field] &= ~excluded[n_field];
+		}
+	} else {
+		if (strcmp(command, "common") == 0)
+			common_ancestors(nodes, n_included, set);
+		else
+			any_ancestors(nodes, n_included, set);
+		subtract_ancestors(nodes + n_included, n_nodes - n_included, set);
+	}
+	for(k=next_in_set(set,0);k!=NO_NODE;k=next_in_set(set,k+1))
+		n_members++;
+	printf("%d nodes:", n_members);
+	for(k=next_in_set(set,0);k!=NO_NODE;k=next_in_set(set,k+1))
+		printf(" %d", k);
+	printf("\n");
+}
+
+void print_rank(int n_node, int low, int high) 
+{
+	if (engine != &matrix_engine) {
+		printf("input ignored: .rank needs the matrix engine\n");
+		return;
+	}
+	if (n_node < 0 || n_node >= TOTAL_NODES || low < 0 || high < low) {
+		printf("input ignored: expected \".rank n low high\" with n from 0 to less than TOTAL_NODES (= %d)"
+					 " and 0 <= low <= high\n", TOTAL_NODES);
+		return;
+	}
+	drain_pending();
+	printf("node %d: %d ancestors from %d to less than %d\n", n_node,
+				 row_range_count(n_node, low, high), low, high);
+}
+
+void print_select(int n_node, int k) 
+{
+	int n_ancestor;
+
+	if (engine != &matrix_engine) {
+		printf("input ignored: .select needs the matrix engine\n");
+		return;
+	}
+	if (n_node < 0 || n_node >= TOTAL_NODES || k < 0) {
+		printf("input ignored: expected \".select n k\" with n from 0 to less than TOTAL_NODES (= %d) and k >= 0\n",
+					 TOTAL_NODES);
+		return;
+	}
+	drain_pending();
+	n_ancestor = row_select(n_node, k);
+	if (n_ancestor == NO_NODE)
+		printf("node %d: only %d ancestors\n", n_node, row_rank(n_node, TOTAL_NODES));
+	else
+		printf("node %d: ancestor %d is %d\n", n_node, k, n_ancestor);
+}
+
+int italiano_is_ancestor(int n_node, int n_ancestor) 
+{
+	/* n_node is a descendant of n_ancestor if it is in n_ancestor's tree */
+	if (n_node == n_ancestor)
+		return(TRUE);
+	if (levels_kept && node_level[n_ancestor] >= node_level[n_node]) {
+		level_prunes++;
+		return(FALSE);
+	}
+	return tree_find(&reach_trees[n_ancestor], n_node) != NULL;
+}
+
+void italiano_insert_ancestors(int start_node, int end_node) 
+{
+	/*
+		Meld end_node's tree into the tree of start_node and of each of its
+		ancestors that cannot reach end_node yet. start_node cannot gain
+		ancestors while this runs, so its list may be walked as it stands.
+	*/
+	struct ancestor_list *list = &ancestor_lists[start_node];
+	int i, n_root;
+
+	for(i=-1;i<list->count;i++)
+		{
+			n_root = i < 0 ? start_node : list->nodes[i];
+			if (!italiano_is_ancestor(end_node,n_root))
+				meld_tree(n_root,start_node,end_node);
+		}
+}
+
+void meld_tree(int n_root, int start_node, int end_node) 
+{
+	/*
+		Copy end_node and the part of its tree that n_root's tree lacks into
+		n_root's tree, hanging end_node below start_node.
+	*/
+	struct reach_tree *end_tree = &reach_trees[end_node];
+	struct tree_entry *entry;
+	int n_stack = 0, n_node, n_child;
+
+	tree_add(n_root, end_node, start_node);
+	meld_stack[n_stack++] = end_node;
+	while (n_stack > 0) {
+		n_node = meld_stack[--n_stack];
+		entry = tree_find(end_tree, n_node);
+		n_child = entry ? entry->first_child : NO_NODE;
+		for(;n_child!=NO_NODE;n_child=tree_find(end_tree, n_child)->next_sibling)
+			{
+				if (!italiano_is_ancestor(n_child,n_root)) {
+					tree_add(n_root, n_child, n_node);
+					meld_stack[n_stack++] = n_child;
+				}
+			}
+	}
+}
+
+struct tree_entry *tree_find(struct reach_tree *tree, int n_node) 
+{
+	/* The entry for n_node, or NULL */
+	unsigned int slot;
+
+	if (tree->size == 0)
+		return NULL;
+	slot = (n_node * 0x9E3779B1u) & (tree->capacity - 1);
+	while (tree->slots[slot].node != NO_NODE) {
+		if (tree->slots[slot].node == n_node)
+			return &tree->slots[slot];
+		slot = (slot + 1) & (tree->capacity - 1);
+	}
+	return NULL;
+}
+
+void tree_add(int n_root, int n_node, int n_parent) 
+{
+	/* Add n_node to n_root's tree as the first child of n_parent */
+	struct reach_tree *tree = &reach_trees[n_root];
+	struct ancestor_list *list = &ancestor_lists[n_node];
+	struct tree_entry *parent;
+	unsigned short *old_nodes;
+	unsigned int slot;
+
+	if (tree->size == 0) {
+		/* The root enters the tree along with its first descendant */
+		tree_grow(tree);
+		slot = (n_root * 0x9E3779B1u) & (tree->capacity - 1);
+		tree->slots[slot].node = n_root;
+		tree->slots[slot].parent = NO_NODE;
+		tree->slots[slot].first_child = NO_NODE;
+		tree->slots[slot].next_sibling = NO_NODE;
+		tree->size = 1;
+	}
+	if (2 * (tree->size + 1) > tree->capacity)
+		tree_grow(tree);
+	slot = (n_node * 0x9E3779B1u) & (tree->capacity - 1);
+	while (tree->slots[slot].node != NO_NODE)
+		slot = (slot + 1) & (tree->capacity - 1);
+	parent = tree_find(tree, n_parent);
+	tree->slots[slot].node = n_node;
+	tree->slots[slot].parent = n_parent;
+	tree->slots[slot].first_child = NO_NODE;
+	tree->slots[slot].next_sibling = parent->first_child;
+	parent->first_child = n_node;
+	tree->size++;
+
+	if (list->count == list->capacity) {
+		old_nodes = list->nodes;
+		list->capacity = list->capacity ? 2 * list->capacity : 4;
+		list->nodes = allocator->allocate(list->capacity * sizeof(unsigned short),
+										sizeof(unsigned short), ANY_NUMA_NODE);
+		if (list->nodes == NULL) {
+			fprintf(stderr, "cycle_detector: out of memory for ancestor lists\n");
+			exit(1);
+		}
+		if (old_nodes) {
+			memcpy(list->nodes, old_nodes, list->count * sizeof(unsigned short));
+			allocator->release(old_nodes, list->count * sizeof(unsigned short));
+		}
+	}
+	list->nodes[list->count++] = n_root;
+	count_new_pair(n_node, n_root);
+}
+
+void tree_grow(struct reach_tree *tree) 
+{
+	/* Double the slots of tree (or make the first 8) and rehash */
+	struct tree_entry *old_slots = tree->slots;
+	int old_capacity = tree->capacity;
+	unsigned int slot;
+	int i;
+
+	tree->capacity = old_capacity ? 2 * old_capacity : 8;
+	tree->slots = allocator->allocate(tree->capacity * sizeof(struct tree_entry),
+									sizeof(int), ANY_NUMA_NODE);
+	if (tree->slots == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory for reachability trees\n");
+		exit(1);
+	}
+	for(i=0;i<tree->capacity;i++)
+		tree->slots[i].node = NO_NODE;
+	for(i=0;i<old_capacity;i++)
+		{
+			if (old_slots[i].node == NO_NODE)
+				continue;
+			slot = (old_slots[i].node * 0x9E3779B1u) & (tree->capacity - 1);
+			while (tree->slots[slot].node != NO_NODE)
+				slot = (slot + 1) & (tree->capacity - 1);
+			tree->slots[slot] = old_slots[i];
+		}
+	allocator->release(old_slots, old_capacity * sizeof(struct tree_entry));
+}
+
+void initialize_versions(int n_kept) 
+{
+	/* Keep the last n_kept versions, starting with version 0, the empty graph */
+	versions_kept = n_kept;
+	versions = malloc(n_kept * sizeof(struct version));
+	if (versions == NULL) {
+		fprintf(stderr, "cycle_detector: out of memory for %d versions\n", n_kept);
+		exit(1);
+	}
+	commit_version();
+}
+
+void commit_version() 
+{
+	/* Make a new version from the last one and the dirty leaves */
+	struct version *last = n_versions ? &versions[(oldest_version + n_versions - 1) % versions_kept] : NULL;
+	struct version_node *root = last ? last->root : NULL;
+	struct version_node *new_root = root;
+	struct version_leaf *leaf;
+	struct version *version;
+	int i, key;
+
+	for(i=0;i<n_dirty_leaves;i++)
+		{
+			key = dirty_leaves[i];
+			leaf = allocator->allocate(sizeof(struct version_leaf), sizeof(FIELD), ANY_NUMA_NODE);
+			if (leaf == NULL) {
+				fprintf(stderr, "cycle_detector: out of memory for versions\n");
+				exit(1);
+			}
+			leaf->refs = 1;
+			memcpy(leaf->fields, &row_of(key / LEAVES_PER_ROW)[key % LEAVES_PER_ROW * VERSION_LEAF_FIELDS],
+						 sizeof(leaf->fields));
+			new_root = version_set(new_root, key, 0, leaf);
+			leaf_is_dirty[key] = FALSE;
+		}
+	n_dirty_leaves = 0;
+	if (new_root == root && root != NULL)
+		root->refs++;
+	if (n_versions == versions_kept) {
+		release_version_node(versions[oldest_version].root, 0);
+		oldest_version = (oldest_version + 1) % versions_kept;
+		n_versions--;
+	}
+	version = &versions[(oldest_version + n_versions) % versions_kept];
+	version->id = next_version_id++;
+	version->time = time(NULL);
+	version->root = new_root;
+	n_versions++;
+}
+
+void *version_set(struct version_node *node, int key, int level, struct version_leaf *leaf) 
+{
+	/*
+		Map key to leaf in the trie at node, which is at the given level.
+		Returns node itself if it was built by the version being made, and
+		otherwise a copy that is. Nodes of older versions are never changed.
+	*/
+	long stamp = next_version_id;
+	int index = (key >> (VERSION_LEVELS - 1 - level) * 5) & 31;
+	unsigned int bit = 1u << index;
+	int position = node ? __builtin_popcount(node->bitmap & (bit - 1)) : 0;
+	int count = node ? __builtin_popcount(node->bitmap) : 0;
+	struct version_node *copy, *child;
+	void *new_child;
+	int i, child_owned;
+
+	if (node == NULL || node->stamp != stamp || !(node->bitmap & bit)) {
+		/* Copy node, making room for the new child if it is not present */
+		copy = malloc(sizeof(struct version_node) + count * sizeof(void *));
+		if (copy == NULL) {
+			fprintf(stderr, "cycle_detector: out of memory for versions\n");
+			exit(1);
+		}
+		copy->stamp = stamp;
+		copy->refs = 1;
+		copy->bitmap = (node ? node->bitmap : 0) | bit;
+		for(i=0;i<count;i++)
+			{
+				copy->children[i + (i >= position && !(node->bitmap & bit))] = node->children[i];
+				if (node->stamp != stamp)
+					retain_version_node(node->children[i], level + 1);
+			}
+		if (!node || !(node->bitmap & bit))
+			copy->children[position] = NULL;
+		if (node && node->stamp == stamp)
+			free(node);
+		node = copy;
+	}
+	if (level == VERSION_LEVELS - 1) {
+		if (node->children[position])
+			release_version_node(node->children[position], level + 1);
+		node->children[position] = leaf;
+	} else {
+		child = node->children[position];
+		child_owned = child && child->stamp == stamp;
+		new_child = version_set(child, key, level + 1, leaf);
+		if (new_child != child && child && !child_owned)
+			release_version_node(child, level + 1);
+		node->children[position] = new_child;
+	}
+	return node;
+}
+
+void retain_version_node(void *node, int level) 
+{
+	/* Add a reference to a trie node, or to a leaf below the last level */
+	if (level == VERSION_LEVELS)
+		((struct version_leaf *)node)->refs++;
+	else
+		((struct version_node *)node)->refs++;
+}
+
+void release_version_node(void *node, int level) 
+{
+	/* Drop a reference to a trie node, or to a leaf below the last level */
+	struct version_node *trie = node;
+	int i;
+
+	if (node == NULL)
+		return;
+	if (level == VERSION_LEVELS) {
+		if (--((struct version_leaf *)node)->refs == 0)
+			allocator->release(node, sizeof(struct version_leaf));
+		return;
+	}
+	if (--trie->refs > 0)
+		return;
+	for(i=0;i<__builtin_popcount(trie->bitmap);i++)
+		release_version_node(trie->children[i], level + 1);
+	free(trie);
+}
+
+struct version *find_version(long id) 
+{
+	/* The version with the given id, or NULL if it is not kept */
+	long oldest;
+
+	if (n_versions == 0)
+		return NULL;
+	oldest = versions[oldest_version].id;
+	if (id < oldest || id >= oldest + n_versions)
+		return NULL;
+	return &versions[(oldest_version + (id - oldest)) % versions_kept];
+}
+
+long version_at_time(time_t when) 
+{
+	/* The id of the last kept version made at or before when, or -1 */
+	int i;
+	struct version *version;
+
+	drain_pending();
+	for(i=n_versions-1;i>=0;i--)
+		{
+			version = &versions[(oldest_version + i) % versions_kept];
+			if (version->time <= when)
+				return version->id;
+		}
+	return -1;
+}
+
+int is_ancestor_at(long id, int n_node, int n_ancestor) 
+{
+	/* is_ancestor as it was in version id, which must be kept */
+	struct version *version = find_version(id);
+	struct version_node *node = version->root;
+	int n_field = n_ancestor / FIELD_SIZE;
+	int key = n_node * LEAVES_PER_ROW + n_field / VERSION_LEAF_FIELDS;
+	struct version_leaf *leaf;
+	unsigned int bit;
+	int level;
+
+	if (n_node == n_ancestor)
+		return(TRUE);
+	for(level=0;node && level<VERSION_LEVELS;level++)
+		{
+			bit = 1u << ((key >> (VERSION_LEVELS - 1 - level) * 5) & 31);
+			if (!(node->bitmap & bit))
+				return(FALSE);
+			node = node->children[__builtin_popcount(node->bitmap & (bit - 1))];
+		}
+	if (node == NULL)
+		return(FALSE);
+	leaf = (struct version_leaf *)node;
+	return (leaf->fields[n_field % VERSION_LEAF_FIELDS] >> (n_ancestor % FIELD_SIZE)) & 1;
+}
+
+int insert_link_at(long id, int start_node, int end_node) 
+{
+	/* What insert_link would have returned in version id, changing nothing */
+	drain_pending();
+	if (find_version(id) == NULL) {
+		printf("input ignored: version %ld is not kept\n", id);
+		return BAD_DATA;
+	}
+	if (start_node < 0 || start_node >= TOTAL_NODES || end_node < 0 || end_node >= TOTAL_NODES) {
+		printf("input ignored: nodes must be from 0 to less than TOTAL_NODES (= %d)\n", TOTAL_NODES);
+		return BAD_DATA;
+	}
+	return is_ancestor_at(id, start_node, end_node) ? FAIL : PASS;
+}
+
+void print_versions() 
+{
+	struct version *newest;
+
+	drain_pending();
+	if (n_versions == 0) {
+		printf("no versions kept (use -v)\n");
+		return;
+	}
+	newest = &versions[(oldest_version + n_versions - 1) % versions_kept];
+	printf("versions %ld to %ld kept, oldest made at %ld, newest at %ld\n",
+				 versions[oldest_version].id, newest->id,
+				 (long)versions[oldest_version].time, (long)newest->time);
+}
+
+void initialize_symbols() 
+{
+	int i;
+
+	for(i=0;i<SYMBOL_SLOTS;i++)
+		symbol_slots[i].node = NO_NODE;
+}
+
+unsigned int hash_name(const char *name, int length) 
+{
+	/* Multiply and rotate a FIELD at a time, finishing with the tail bytes */
+	unsigned long long hash = length * 0x9E3779B97F4A7C15ULL;
+	FIELD word;
+	int i;
+
+	for(i=0;i+(int)sizeof(FIELD)<=length;i+=sizeof(FIELD))
+		{
+			memcpy(&word, name + i, sizeof(FIELD));
+			hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+			hash ^= hash >> 29;
+		}
+	for(;i<length;i++)
+		hash = (hash ^ (unsigned char)name[i]) * 0x94D049BB133111EBULL;
+	hash ^= hash >> 32;
+	return (unsigned int)hash;
+}
+
+int intern_node(const char *name, int length) 
+{
+	/* The node named name, numbered now if it is new. NO_NODE if full. */
+	unsigned int hash = hash_name(name, length);
+	unsigned int slot = hash & (SYMBOL_SLOTS - 1);
+	int n_node;
+
+	while ((n_node = symbol_slots[slot].node) != NO_NODE) {
+		if (symbol_slots[slot].hash == hash && symbol_length[n_node] == length
+				&& memcmp(symbol_arena + symbol_offset[n_node], name, length) == 0)
+			return n_node;
+		slot = (slot + 1) & (SYMBOL_SLOTS - 1);
+	}
+	if (n_symbols == TOTAL_NODES || symbol_arena_used + length > SYMBOL_ARENA_BYTES)
+		return NO_NODE;
+	n_node = n_symbols++;
+	memcpy(symbol_arena + symbol_arena_used, name, length);
+	symbol_offset[n_node] = symbol_arena_used;
+	symbol_length[n_node] = length;
+	symbol_arena_used += length;
+	symbol_slots[slot].hash = hash;
+	symbol_slots[slot].node = n_node;
+	return n_node;
+}
+
+const char *node_name(int n_node, int *length) 
+{
+	/* The name of n_node (not NUL terminated), or NULL if it has none */
+	if (n_node < 0 || n_node >= n_symbols)
+		return NULL;
+	*length = symbol_length[n_node];
+	return symbol_arena + symbol_offset[n_node];
+}
+
+int insert_link_named(const char *start_name, const char *end_name, int deferred) 
+{
+	int start_node = intern_node(start_name, strlen(start_name));
+	int end_node = intern_node(end_name, strlen(end_name));
+
+	if (start_node == NO_NODE || end_node == NO_NODE) {
+		printf("input ignored: ");
+		printf("no room for more node names (%d in use)\n", n_symbols);
+		return BAD_DATA;
+	}
+	if (deferred)
+		return insert_link_deferred(start_node, end_node);
+	return insert_link(start_node, end_node);
+}
+
+void print_result(int result) 
+{
+	if(result == FAIL) 
+		{
+			printf("Cycle found\n");
+		}
+	if(result == PASS)
+		printf("Good insert\n");
+	if(result == BAD_DATA)
+		printf("Bad (out of bounds) data\n");
+	if(result == MERGED)
+		printf("Cycle merged\n");
+}
+
+void print_closure_stats() 
+{
+	struct closure_stats stats;
+	int i;
+
+	drain_pending();
+	if (engine == &bloom_engine) {
+		printf("linked nodes: %d\n", linked_nodes);
+		printf("bloom filters: %d FIELDs, %d bits per ancestor, estimated false positive rate %.6f\n",
+					 bloom_fields, bloom_hashes, bloom_false_positive_rate());
+		print_level_stats();
+		return;
+	}
+	get_closure_stats(&stats);
+	printf("reachable pairs: %ld\n", stats.reachable_pairs);
+	printf("linked nodes: %d\n", stats.linked_nodes);
+	printf("ancestors per node: average %.2f, maximum %d (node %d)\n",
+				 stats.average_ancestors, stats.max_ancestors, stats.max_ancestors_node);
+	printf("descendants per node: average %.2f, maximum %d (node %d)\n",
+				 stats.average_descendants, stats.max_descendants, stats.max_descendants_node);
+	printf("most connected:");
+	for(i=0;i<stats.n_top;i++)
+		printf(" %d (%d)", stats.top_nodes[i], stats.top_connections[i]);
+	printf("\n");
+	printf("row unions: %ld, blocks written: %ld of %ld\n",
+				 stats.row_unions, stats.blocks_written, stats.blocks_tested);
+	if (budget_rows)
+		printf("row budget: %d rows unpacked of %d, %d packed in %ld bytes, %ld of %ld accesses found a row packed (%.2f%%)\n",
+					 n_clock_rows, budget_rows, n_packed_rows, packed_bytes, packed_hits, row_accesses,
+					 row_accesses ? 100.0 * packed_hits / row_accesses : 0.0);
+	if (condensing)
+		printf("strong components: %d nodes folded into %d components\n", n_folded, n_strong);
+	print_level_stats();
+}
+
+void run_command(char *line) 
+{
+	/* Lines starting with "." are commands rather than links */
+	char command[32];
+	int n_node, start_node, end_node;
+	long id;
+
+	if (sscanf(line, ".%31s", command) != 1)
+		command[0] = '\0';
+	if (strcmp(command, "stats") == 0)
+		print_closure_stats();
+	else if (strcmp(command, "count") == 0 && sscanf(line, ".%*s %d", &n_node) == 1)
+		print_counts(n_node);
+	else if (strcmp(command, "versions") == 0)
+		print_versions();
+	else if (strcmp(command, "at") == 0 && sscanf(line, ".%*s %ld %d %d", &id, &start_node, &end_node) == 3)
+		print_result(insert_link_at(id, start_node, end_node));
+	else if (strcmp(command, "asof") == 0 && sscanf(line, ".%*s %ld %d %d", &id, &start_node, &end_node) == 3)
+		print_result(insert_link_at(version_at_time(id), start_node, end_node));
+	else if (strcmp(command, "common") == 0 || strcmp(command, "ancestors") == 0 || strcmp(command, "reach") == 0)
+		run_set_query(command, line);
+	else if (strcmp(command, "rank") == 0 && sscanf(line, ".%*s %d %d %d", &n_node, &start_node, &end_node) == 3)
+		print_rank(n_node, start_node, end_node);
+	else if (strcmp(command, "select") == 0 && sscanf(line, ".%*s %d %d", &n_node, &start_node) == 2)
+		print_select(n_node, start_node);
+	else if (strcmp(command, "export") == 0)
+		run_export(line);
+	else if (strcmp(command, "component") == 0 && sscanf(line, ".%*s %d", &n_node) == 1)
+		print_strong_component(n_node);
+	else if (strcmp(command, "level") == 0 && sscanf(line, ".%*s %d", &n_node) == 1)
+		print_level(n_node);
+	else
+		printf("input ignored: unknown command \"%s\"\n", command);
+}
+
+void run_batches(int atomic) 
+{
+	/*
+		-b and -a: read batches of "start end [priority]" separated by blank
+		lines. The priority is not used by atomic batches.
+	*/
+	struct batch_link *batch = NULL;
+	struct link *links;
+	int n_links = 0, n_allocated = 0;
+	int i, fields, at_end = FALSE;
+	char line[LINE_BYTES];
+
+	while (!at_end) {
+		fields = read_line(line, sizeof(line));
+		at_end = !fields;
+		if (fields == LONG_LINE) {
+			print_long_line(input_line);
+			continue;
+		}
+		if (!at_end && n_links == n_allocated) {
+			n_allocated = n_allocated ? 2 * n_allocated : 256;
+			batch = realloc(batch, n_allocated * sizeof(struct batch_link));
+			if (batch == NULL) {
+				fprintf(stderr, "cycle_detector: out of memory for batch of %d links\n", n_allocated);
+				exit(1);
+			}
+		}
+		if (!at_end) {
+			batch[n_links].priority = 0;
+			fields = sscanf(line, "%d %d %d", &batch[n_links].start,
+											&batch[n_links].end, &batch[n_links].priority);
+			if (fields >= 2) {
+				n_links++;
+				continue;
+			}
+			if (fields != EOF) {
+				printf("input ignored: expected \"start end [priority]\" on line %ld\n", input_line);
+				continue;
+			}
+		}
+		/* A blank line or end of input submits the batch */
+		if (atomic && n_links > 0) {
+			links = malloc(n_links * sizeof(struct link));
+			if (links == NULL) {
+				fprintf(stderr, "cycle_detector: out of memory for batch of %d links\n", n_links);
+				exit(1);
+			}
+			for(i=0;i<n_links;i++)
+				{
+					links[i].start = batch[i].start;
+					links[i].end = batch[i].end;
+				}
+			print_result(insert_links_atomic(links, n_links));
+			free(links);
+		} else if (!atomic) {
+			insert_links_greedy(batch, n_links);
+			for(i=0;i<n_links;i++)
+				print_result(batch[i].result);
+		}
+		fflush(stdout);
+		n_links = 0;
+	}
+	free(batch);
+}
+
+int main (int argc, char *argv[]) 
+{
+	int start_node, end_node, result, option, i, n_kept = 0;
+	int deferred = FALSE, batches = FALSE, atomic = FALSE, named = FALSE, pipelined = FALSE;
+	int queued = FALSE;
+	char *successor_path = NULL, *predecessor_path = NULL, *log_path = NULL, *replay_path = NULL;
+	char *ingest_path = NULL;
+	long budget_megabytes;
+	char line[LINE_BYTES], start_name[LINE_BYTES], end_name[LINE_BYTES];
+
+	while ((option = getopt(argc, argv, "dbae:k:w:sv:nH:T:po:r:f:m:A:qEcL")) != -1) {
+		switch (option) {
+		case 'd':
+			deferred = TRUE;
+			break;
+		case 'b':
+			batches = TRUE;
+			break;
+		case 'a':
+			batches = TRUE;
+			atomic = TRUE;
+			break;
+		case 'e':
+			for(i=0;engines[i] && strcmp(optarg, engines[i]->name) != 0;i++)
+				;
+			if (engines[i] == NULL) {
+				fprintf(stderr, "%s: unknown engine \"%s\"\n", argv[0], optarg);
+				return 1;
+			}
+			engine = engines[i];
+			break;
+		case 'k':
+			bloom_hashes = atoi(optarg);
+			if (bloom_hashes < 1 || bloom_hashes > BLOOM_HASHES) {
+				fprintf(stderr, "%s: -k must be from 1 to %d\n", argv[0], BLOOM_HASHES);
+				return 1;
+			}
+			break;
+		case 'w':
+			bloom_fields = atoi(optarg);
+			if (bloom_fields < 1 || bloom_fields > BLOOM_FIELDS) {
+				fprintf(stderr, "%s: -w must be from 1 to %d\n", argv[0], BLOOM_FIELDS);
+				return 1;
+			}
+			break;
+		case 's':
+			sketches = TRUE;
+			break;
+		case 'v':
+			n_kept = atoi(optarg);
+			if (n_kept < 1) {
+				fprintf(stderr, "%s: -v must be at least 1\n", argv[0]);
+				return 1;
+			}
+			break;
+		case 'n':
+			named = TRUE;
+			break;
+		case 'H':
+			successor_path = optarg;
+			break;
+		case 'T':
+			predecessor_path = optarg;
+			break;
+		case 'p':
+			pipelined = TRUE;
+			break;
+		case 'o':
+			log_path = optarg;
+			break;
+		case 'r':
+			replay_path = optarg;
+			break;
+		case 'f':
+			ingest_path = optarg;
+			break;
+		case 'm':
+			budget_megabytes = atol(optarg);
+			if (budget_megabytes < 1) {
+				fprintf(stderr, "%s: -m must be at least 1\n", argv[0]);
+				return 1;
+			}
+			budget_rows = budget_megabytes * 1024 * 1024 / ROW_BYTES;
+			break;
+		case 'A':
+			for(i=0;allocators[i] && strcmp(optarg, allocators[i]->name) != 0;i++)
+				;
+			if (allocators[i] == NULL) {
+				fprintf(stderr, "%s: unknown allocator \"%s\"\n", argv[0], optarg);
+				return 1;
+			}
+			allocator = allocators[i];
+			break;
+		case 'q':
+			queued = TRUE;
+			break;
+		case 'E':
+			edges_kept = TRUE;
+			break;
+		case 'c':
+			condensing = TRUE;
+			break;
+		case 'L':
+			levels_kept = TRUE;
+			edges_kept = TRUE;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-d | -b | -a] [-e engine] [-k hashes] [-w fields] [-s] [-v count] [-n]"
+							" [-H path] [-T path] [-p] [-o path] [-r path] [-f path] [-m megabytes]"
+							" [-A allocator] [-q] [-E] [-c] [-L]\n", argv[0]);
+			return 1;
+		}
+	}
+	if ((successor_path || predecessor_path)
+			&& (batches || sketches || n_kept || edges_kept || engine == &italiano_engine)) {
+		fprintf(stderr, "%s: -H and -T need line mode, the matrix or bloom engine, and no -s, -v, -E or -L\n", argv[0]);
+		return 1;
+	}
+	if (pipelined && (batches || successor_path || predecessor_path)) {
+		fprintf(stderr, "%s: -p works in line mode only, without -H or -T\n", argv[0]);
+		return 1;
+	}
+	if (queued && (batches || pipelined || successor_path || predecessor_path)) {
+		fprintf(stderr, "%s: -q works in line mode only, without -p, -H or -T\n", argv[0]);
+		return 1;
+	}
+	if ((log_path || replay_path || ingest_path) && (named || successor_path || predecessor_path)) {
+		fprintf(stderr, "%s: -o, -r and -f do not work with -n, -H or -T\n", argv[0]);
+		return 1;
+	}
+	if (condensing && (engine != &matrix_engine || deferred || batches || sketches || n_kept || budget_rows
+										 || log_path || replay_path || ingest_path || edges_kept
+										 || successor_path || predecessor_path)) {
+		fprintf(stderr, "%s: -c needs the matrix engine in line mode, and no -d, -s, -v, -m, -o, -r, -f, -E, -L, -H or -T\n",
+						argv[0]);
+		return 1;
+	}
+	if (budget_rows && engine != &matrix_engine) {
+		fprintf(stderr, "%s: -m needs the matrix engine\n", argv[0]);
+		return 1;
+	}
+	initialize_matrix(successor_path != NULL);
+	if (n_kept) {
+		if (engine != &matrix_engine) {
+			fprintf(stderr, "%s: -v needs the matrix engine\n", argv[0]);
+			return 1;
+		}
+		initialize_versions(n_kept);
+	}
+	initialize_components();
+	if (condensing)
+		initialize_strong_components();
+	initialize_symbols();
+	if (predecessor_path)
+		take_over(predecessor_path);
+	if (successor_path)
+		listen_for_successor(successor_path);
+	if (replay_path)
+		replay_link_log(replay_path);
+	if (log_path)
+		open_link_log(log_path);
+	if (ingest_path)
+		ingest_file(ingest_path, deferred);
+	if (batches) {
+		run_batches(atomic);
+		close_link_log();
+		return 0;
+	}
+	if (pipelined) {
+		run_pipeline(deferred, named);
+		close_link_log();
+		return 0;
+	}
+	if (queued) {
+		run_async_lines(named);
+		close_link_log();
+		return 0;
+	}
+	while (TRUE) {
+		printf ("Enter start end:  ");
+		fflush(stdout);
+		wait_for_input(deferred);
+		result = read_line(line, sizeof(line));
+		if (!result)
+			break;
+		if (result == LONG_LINE) {
+			print_long_line(input_line);
+			continue;
+		}
+		if (line[0] == '.') {
+			run_command(line);
+			continue;
+		}
+		if (named) {
+			result = sscanf(line, "%255s %255s", start_name, end_name);
+			if (result == 2)
+				print_result(insert_link_named(start_name, end_name, deferred));
+			else if (result != EOF)
+				printf("input ignored: expected \"start end\" on line %ld\n", input_line);
+			continue;
+		}
+		result = parse_pair(line, sizeof(line), &start_node, &end_node);
+		if (result == EOF)
+			continue;
+		if (result != 2) {
+			printf("input ignored: expected \"start end\" on line %ld\n", input_line);
+			continue;
+		}
+		if (deferred)
+			result = insert_link_deferred(start_node, end_node);
+		else
+			result = insert_link(start_node, end_node);
+		print_result(result);
+	}
+	drain_pending();
+	close_link_log();
+	return 0;
+}
@@ -0,0 +1,11 @@
+100 101
+101 102
+200 201
+201 202
+102 100
+202 200
+102 200
+202 100
+201 101
+300 301
+301 300
@@ -0,0 +1,12 @@
+0 1
+1 2
+
+2 3
+3 0
+4 5
+
+4 5
+5 6
+
+3 4
+6 0
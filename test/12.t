@@ -0,0 +1,9 @@
+0 1
+1 2
+2 3
+0 4
+4 3
+.stats
+3 0
+.stats
+.frobnicate
@@ -0,0 +1,10 @@
+0 511
+511 512
+512 4095
+4095 65535
+0 65535
+0 65535
+511 4095
+65535 0
+65535 512
+.stats
@@ -0,0 +1,8 @@
+5 5
+0 0
+65535 65535
+7 8
+8 7
+8 8
+65536 1
+1 -1
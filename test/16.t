@@ -0,0 +1,66 @@
+0 1
+1 100
+0 2
+2 100
+0 3
+3 100
+0 4
+4 100
+0 5
+5 100
+0 6
+6 100
+0 7
+7 100
+0 8
+8 100
+0 9
+9 100
+0 10
+10 100
+0 11
+11 100
+0 12
+12 100
+0 13
+13 100
+0 14
+14 100
+0 15
+15 100
+0 16
+16 100
+0 17
+17 100
+0 18
+18 100
+0 19
+19 100
+0 20
+20 100
+0 21
+21 100
+0 22
+22 100
+0 23
+23 100
+0 24
+24 100
+0 25
+25 100
+0 26
+26 100
+0 27
+27 100
+0 28
+28 100
+0 29
+29 100
+0 30
+30 100
+100 200
+.count 0
+.count 100
+.count 200
+.count 7
+.stats
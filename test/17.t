@@ -0,0 +1,14 @@
+0 1
+1 2
+2 3
+10 11
+11 2
+3 10
+3 0
+3 11
+20 21
+21 22
+22 0
+3 20
+0 3
+.stats
@@ -0,0 +1,13 @@
+0 1
+.versions
+1 2
+2 3
+.versions
+.at 1 2 0
+.at 3 2 0
+.at 3 3 0
+.at 9 0 1
+.asof 0 2 0
+.asof 4102444800 3 0
+2 0
+.versions
@@ -0,0 +1,4 @@
+0 1
+1 2
+2 3
+.stats
@@ -0,0 +1,4 @@
+3 0
+3 4
+4 1
+.stats
@@ -0,0 +1,12 @@
+0 1
+1 2
+foo bar
+2 0
+
+.stats
+2 3
+3 1
+99999 1
+4 4
+.stats
+3 4
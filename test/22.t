@@ -0,0 +1,15 @@
+1 2
+2    3
+3	4
+ 4 5
+0005 0006
+6 7   
+7 8 extra
+8 1
+1234567 1
+12345678 1
+-3 4
++9 10
+10 +9
+1 2
+9
@@ -0,0 +1,5 @@
+0 1
+1 2
+2 0
+2 3
+300 301
@@ -0,0 +1,4 @@
+3 0
+301 300
+3 300
+.stats
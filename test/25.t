@@ -0,0 +1,9 @@
+0 1
+1 2
+not a link
+2 0
+.stats
+2 3
+
+3 1
+4 5
\ No newline at end of file
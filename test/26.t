@@ -0,0 +1,506 @@
+0 1
+1 2
+2 3
+3 4
+4 5
+5 6
+6 7
+7 8
+8 9
+9 10
+10 11
+11 12
+12 13
+13 14
+14 15
+15 16
+16 17
+17 18
+18 19
+19 20
+20 21
+21 22
+22 23
+23 24
+24 25
+25 26
+26 27
+27 28
+28 29
+29 30
+30 31
+31 32
+32 33
+33 34
+34 35
+35 36
+36 37
+37 38
+38 39
+39 40
+40 41
+41 42
+42 43
+43 44
+44 45
+45 46
+46 47
+47 48
+48 49
+49 50
+50 51
+51 52
+52 53
+53 54
+54 55
+55 56
+56 57
+57 58
+58 59
+59 60
+60 61
+61 62
+62 63
+63 64
+64 65
+65 66
+66 67
+67 68
+68 69
+69 70
+70 71
+71 72
+72 73
+73 74
+74 75
+75 76
+76 77
+77 78
+78 79
+79 80
+80 81
+81 82
+82 83
+83 84
+84 85
+85 86
+86 87
+87 88
+88 89
+89 90
+90 91
+91 92
+92 93
+93 94
+94 95
+95 96
+96 97
+97 98
+98 99
+99 100
+100 101
+101 102
+102 103
+103 104
+104 105
+105 106
+106 107
+107 108
+108 109
+109 110
+110 111
+111 112
+112 113
+113 114
+114 115
+115 116
+116 117
+117 118
+118 119
+119 120
+120 121
+121 122
+122 123
+123 124
+124 125
+125 126
+126 127
+127 128
+128 129
+129 130
+130 131
+131 132
+132 133
+133 134
+134 135
+135 136
+136 137
+137 138
+138 139
+139 140
+140 141
+141 142
+142 143
+143 144
+144 145
+145 146
+146 147
+147 148
+148 149
+149 150
+150 151
+151 152
+152 153
+153 154
+154 155
+155 156
+156 157
+157 158
+158 159
+159 160
+160 161
+161 162
+162 163
+163 164
+164 165
+165 166
+166 167
+167 168
+168 169
+169 170
+170 171
+171 172
+172 173
+173 174
+174 175
+175 176
+176 177
+177 178
+178 179
+179 180
+180 181
+181 182
+182 183
+183 184
+184 185
+185 186
+186 187
+187 188
+188 189
+189 190
+190 191
+191 192
+192 193
+193 194
+194 195
+195 196
+196 197
+197 198
+198 199
+199 200
+200 201
+201 202
+202 203
+203 204
+204 205
+205 206
+206 207
+207 208
+208 209
+209 210
+210 211
+211 212
+212 213
+213 214
+214 215
+215 216
+216 217
+217 218
+218 219
+219 220
+220 221
+221 222
+222 223
+223 224
+224 225
+225 226
+226 227
+227 228
+228 229
+229 230
+230 231
+231 232
+232 233
+233 234
+234 235
+235 236
+236 237
+237 238
+238 239
+239 240
+240 241
+241 242
+242 243
+243 244
+244 245
+245 246
+246 247
+247 248
+248 249
+249 250
+250 251
+251 252
+252 253
+253 254
+254 255
+255 256
+256 257
+257 258
+258 259
+259 260
+260 261
+261 262
+262 263
+263 264
+264 265
+265 266
+266 267
+267 268
+268 269
+269 270
+270 271
+271 272
+272 273
+273 274
+274 275
+275 276
+276 277
+277 278
+278 279
+279 280
+280 281
+281 282
+282 283
+283 284
+284 285
+285 286
+286 287
+287 288
+288 289
+289 290
+290 291
+291 292
+292 293
+293 294
+294 295
+295 296
+296 297
+297 298
+298 299
+299 300
+.stats
+300 0
+150 10
+1000 5000
+1002 5000
+1004 5000
+1006 5000
+1008 5000
+1010 5000
+1012 5000
+1014 5000
+1016 5000
+1018 5000
+1020 5000
+1022 5000
+1024 5000
+1026 5000
+1028 5000
+1030 5000
+1032 5000
+1034 5000
+1036 5000
+1038 5000
+1040 5000
+1042 5000
+1044 5000
+1046 5000
+1048 5000
+1050 5000
+1052 5000
+1054 5000
+1056 5000
+1058 5000
+1060 5000
+1062 5000
+1064 5000
+1066 5000
+1068 5000
+1070 5000
+1072 5000
+1074 5000
+1076 5000
+1078 5000
+1080 5000
+1082 5000
+1084 5000
+1086 5000
+1088 5000
+1090 5000
+1092 5000
+1094 5000
+1096 5000
+1098 5000
+1100 5000
+1102 5000
+1104 5000
+1106 5000
+1108 5000
+1110 5000
+1112 5000
+1114 5000
+1116 5000
+1118 5000
+1120 5000
+1122 5000
+1124 5000
+1126 5000
+1128 5000
+1130 5000
+1132 5000
+1134 5000
+1136 5000
+1138 5000
+1140 5000
+1142 5000
+1144 5000
+1146 5000
+1148 5000
+1150 5000
+1152 5000
+1154 5000
+1156 5000
+1158 5000
+1160 5000
+1162 5000
+1164 5000
+1166 5000
+1168 5000
+1170 5000
+1172 5000
+1174 5000
+1176 5000
+1178 5000
+1180 5000
+1182 5000
+1184 5000
+1186 5000
+1188 5000
+1190 5000
+1192 5000
+1194 5000
+1196 5000
+1198 5000
+1200 5000
+1202 5000
+1204 5000
+1206 5000
+1208 5000
+1210 5000
+1212 5000
+1214 5000
+1216 5000
+1218 5000
+1220 5000
+1222 5000
+1224 5000
+1226 5000
+1228 5000
+1230 5000
+1232 5000
+1234 5000
+1236 5000
+1238 5000
+1240 5000
+1242 5000
+1244 5000
+1246 5000
+1248 5000
+1250 5000
+1252 5000
+1254 5000
+1256 5000
+1258 5000
+1260 5000
+1262 5000
+1264 5000
+1266 5000
+1268 5000
+1270 5000
+1272 5000
+1274 5000
+1276 5000
+1278 5000
+1280 5000
+1282 5000
+1284 5000
+1286 5000
+1288 5000
+1290 5000
+1292 5000
+1294 5000
+1296 5000
+1298 5000
+1300 5000
+1302 5000
+1304 5000
+1306 5000
+1308 5000
+1310 5000
+1312 5000
+1314 5000
+1316 5000
+1318 5000
+1320 5000
+1322 5000
+1324 5000
+1326 5000
+1328 5000
+1330 5000
+1332 5000
+1334 5000
+1336 5000
+1338 5000
+1340 5000
+1342 5000
+1344 5000
+1346 5000
+1348 5000
+1350 5000
+1352 5000
+1354 5000
+1356 5000
+1358 5000
+1360 5000
+1362 5000
+1364 5000
+1366 5000
+1368 5000
+1370 5000
+1372 5000
+1374 5000
+1376 5000
+1378 5000
+1380 5000
+1382 5000
+1384 5000
+1386 5000
+1388 5000
+1390 5000
+1392 5000
+1394 5000
+1396 5000
+1398 5000
+1400 5000
+5000 1200
+.stats
@@ -0,0 +1,13 @@
+0 2
+1 2
+2 3
+4 3
+5 6
+.common 3 6
+.common 2 3
+.ancestors 3 6
+.ancestors 3 - 2
+.reach 0
+.reach 0 4 - 2
+.reach 6 99999
+.common
@@ -0,0 +1,211 @@
+0 1000
+3 1000
+6 1000
+9 1000
+12 1000
+15 1000
+18 1000
+21 1000
+24 1000
+27 1000
+30 1000
+33 1000
+36 1000
+39 1000
+42 1000
+45 1000
+48 1000
+51 1000
+54 1000
+57 1000
+60 1000
+63 1000
+66 1000
+69 1000
+72 1000
+75 1000
+78 1000
+81 1000
+84 1000
+87 1000
+90 1000
+93 1000
+96 1000
+99 1000
+102 1000
+105 1000
+108 1000
+111 1000
+114 1000
+117 1000
+120 1000
+123 1000
+126 1000
+129 1000
+132 1000
+135 1000
+138 1000
+141 1000
+144 1000
+147 1000
+150 1000
+153 1000
+156 1000
+159 1000
+162 1000
+165 1000
+168 1000
+171 1000
+174 1000
+177 1000
+180 1000
+183 1000
+186 1000
+189 1000
+192 1000
+195 1000
+198 1000
+201 1000
+204 1000
+207 1000
+210 1000
+213 1000
+216 1000
+219 1000
+222 1000
+225 1000
+228 1000
+231 1000
+234 1000
+237 1000
+240 1000
+243 1000
+246 1000
+249 1000
+252 1000
+255 1000
+258 1000
+261 1000
+264 1000
+267 1000
+270 1000
+273 1000
+276 1000
+279 1000
+282 1000
+285 1000
+288 1000
+291 1000
+294 1000
+297 1000
+300 1000
+303 1000
+306 1000
+309 1000
+312 1000
+315 1000
+318 1000
+321 1000
+324 1000
+327 1000
+330 1000
+333 1000
+336 1000
+339 1000
+342 1000
+345 1000
+348 1000
+351 1000
+354 1000
+357 1000
+360 1000
+363 1000
+366 1000
+369 1000
+372 1000
+375 1000
+378 1000
+381 1000
+384 1000
+387 1000
+390 1000
+393 1000
+396 1000
+399 1000
+402 1000
+405 1000
+408 1000
+411 1000
+414 1000
+417 1000
+420 1000
+423 1000
+426 1000
+429 1000
+432 1000
+435 1000
+438 1000
+441 1000
+444 1000
+447 1000
+450 1000
+453 1000
+456 1000
+459 1000
+462 1000
+465 1000
+468 1000
+471 1000
+474 1000
+477 1000
+480 1000
+483 1000
+486 1000
+489 1000
+492 1000
+495 1000
+498 1000
+501 1000
+504 1000
+507 1000
+510 1000
+513 1000
+516 1000
+519 1000
+522 1000
+525 1000
+528 1000
+531 1000
+534 1000
+537 1000
+540 1000
+543 1000
+546 1000
+549 1000
+552 1000
+555 1000
+558 1000
+561 1000
+564 1000
+567 1000
+570 1000
+573 1000
+576 1000
+579 1000
+582 1000
+585 1000
+588 1000
+591 1000
+594 1000
+597 1000
+600 1000
+.rank 1000 0 65535
+.rank 1000 0 99
+.rank 1000 512 600
+.rank 1000 10 5
+.select 1000 0
+.select 1000 34
+.select 1000 200
+.select 1000 201
+.select 5 0
+.select 1000 -1
@@ -0,0 +1,405 @@
+0 1
+1000 1001
+1 2
+1001 1002
+2 3
+1002 1003
+3 4
+1003 1004
+4 5
+1004 1005
+5 6
+1005 1006
+6 7
+1006 1007
+7 8
+1007 1008
+8 9
+1008 1009
+9 10
+1009 1010
+10 11
+1010 1011
+11 12
+1011 1012
+12 13
+1012 1013
+13 14
+1013 1014
+14 15
+1014 1015
+15 16
+1015 1016
+16 17
+1016 1017
+17 18
+1017 1018
+18 19
+1018 1019
+19 20
+1019 1020
+20 21
+1020 1021
+21 22
+1021 1022
+22 23
+1022 1023
+23 24
+1023 1024
+24 25
+1024 1025
+25 26
+1025 1026
+26 27
+1026 1027
+27 28
+1027 1028
+28 29
+1028 1029
+29 30
+1029 1030
+30 31
+1030 1031
+31 32
+1031 1032
+32 33
+1032 1033
+33 34
+1033 1034
+34 35
+1034 1035
+35 36
+1035 1036
+36 37
+1036 1037
+37 38
+1037 1038
+38 39
+1038 1039
+39 40
+1039 1040
+40 41
+1040 1041
+41 42
+1041 1042
+42 43
+1042 1043
+43 44
+1043 1044
+44 45
+1044 1045
+45 46
+1045 1046
+46 47
+1046 1047
+47 48
+1047 1048
+48 49
+1048 1049
+49 50
+1049 1050
+50 51
+1050 1051
+51 52
+1051 1052
+52 53
+1052 1053
+53 54
+1053 1054
+54 55
+1054 1055
+55 56
+1055 1056
+56 57
+1056 1057
+57 58
+1057 1058
+58 59
+1058 1059
+59 60
+1059 1060
+60 61
+1060 1061
+61 62
+1061 1062
+62 63
+1062 1063
+63 64
+1063 1064
+64 65
+1064 1065
+65 66
+1065 1066
+66 67
+1066 1067
+67 68
+1067 1068
+68 69
+1068 1069
+69 70
+1069 1070
+70 71
+1070 1071
+71 72
+1071 1072
+72 73
+1072 1073
+73 74
+1073 1074
+74 75
+1074 1075
+75 76
+1075 1076
+76 77
+1076 1077
+77 78
+1077 1078
+78 79
+1078 1079
+79 80
+1079 1080
+80 81
+1080 1081
+81 82
+1081 1082
+82 83
+1082 1083
+83 84
+1083 1084
+84 85
+1084 1085
+85 86
+1085 1086
+86 87
+1086 1087
+87 88
+1087 1088
+88 89
+1088 1089
+89 90
+1089 1090
+90 91
+1090 1091
+91 92
+1091 1092
+92 93
+1092 1093
+93 94
+1093 1094
+94 95
+1094 1095
+95 96
+1095 1096
+96 97
+1096 1097
+97 98
+1097 1098
+98 99
+1098 1099
+99 100
+1099 1100
+100 101
+1100 1101
+101 102
+1101 1102
+102 103
+1102 1103
+103 104
+1103 1104
+104 105
+1104 1105
+105 106
+1105 1106
+106 107
+1106 1107
+107 108
+1107 1108
+108 109
+1108 1109
+109 110
+1109 1110
+110 111
+1110 1111
+111 112
+1111 1112
+112 113
+1112 1113
+113 114
+1113 1114
+114 115
+1114 1115
+115 116
+1115 1116
+116 117
+1116 1117
+117 118
+1117 1118
+118 119
+1118 1119
+119 120
+1119 1120
+120 121
+1120 1121
+121 122
+1121 1122
+122 123
+1122 1123
+123 124
+1123 1124
+124 125
+1124 1125
+125 126
+1125 1126
+126 127
+1126 1127
+127 128
+1127 1128
+128 129
+1128 1129
+129 130
+1129 1130
+130 131
+1130 1131
+131 132
+1131 1132
+132 133
+1132 1133
+133 134
+1133 1134
+134 135
+1134 1135
+135 136
+1135 1136
+136 137
+1136 1137
+137 138
+1137 1138
+138 139
+1138 1139
+139 140
+1139 1140
+140 141
+1140 1141
+141 142
+1141 1142
+142 143
+1142 1143
+143 144
+1143 1144
+144 145
+1144 1145
+145 146
+1145 1146
+146 147
+1146 1147
+147 148
+1147 1148
+148 149
+1148 1149
+149 150
+1149 1150
+150 151
+1150 1151
+151 152
+1151 1152
+152 153
+1152 1153
+153 154
+1153 1154
+154 155
+1154 1155
+155 156
+1155 1156
+156 157
+1156 1157
+157 158
+1157 1158
+158 159
+1158 1159
+159 160
+1159 1160
+160 161
+1160 1161
+161 162
+1161 1162
+162 163
+1162 1163
+163 164
+1163 1164
+164 165
+1164 1165
+165 166
+1165 1166
+166 167
+1166 1167
+167 168
+1167 1168
+168 169
+1168 1169
+169 170
+1169 1170
+170 171
+1170 1171
+171 172
+1171 1172
+172 173
+1172 1173
+173 174
+1173 1174
+174 175
+1174 1175
+175 176
+1175 1176
+176 177
+1176 1177
+177 178
+1177 1178
+178 179
+1178 1179
+179 180
+1179 1180
+180 181
+1180 1181
+181 182
+1181 1182
+182 183
+1182 1183
+183 184
+1183 1184
+184 185
+1184 1185
+185 186
+1185 1186
+186 187
+1186 1187
+187 188
+1187 1188
+188 189
+1188 1189
+189 190
+1189 1190
+190 191
+1190 1191
+191 192
+1191 1192
+192 193
+1192 1193
+193 194
+1193 1194
+194 195
+1194 1195
+195 196
+1195 1196
+196 197
+1196 1197
+197 198
+1197 1198
+198 199
+1198 1199
+199 200
+1199 1200
+200 0
+1200 1000
+200 1000
+1200 0
+.stats
@@ -0,0 +1,12 @@
+0 1
+1 2
+0 2
+2 3
+0 3
+5 3
+3 0
+.export closure csv |cat
+.export order csv |cat
+.export reduction csv |cat
+.export closure binary |od -An -tx1
+.export nothing csv |cat
@@ -0,0 +1,14 @@
+0 1
+1 2
+2 0
+.component 0
+.component 1
+3 4
+4 0
+2 3
+.component 4
+.component 5
+5 6
+6 5
+0 2
+.stats
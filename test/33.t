@@ -0,0 +1,13 @@
+0 1
+1 2
+.level 2
+3 0
+.level 2
+.level 3
+4 2
+.level 4
+2 3
+5 5
+.level 9
+.level 70000
+.stats
@@ -0,0 +1,7 @@
+0 1 0
+1 2 0
+2 0 9
+3 4 0
+4 3 1
+
+2 3
@@ -0,0 +1,4 @@
+build-core deploy-api
+deploy-api smoke-test
+smoke-test build-core
+build-core smoke-test
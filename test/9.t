@@ -0,0 +1,11 @@
+0 1
+1 2
+2 3
+3 0
+10 11
+11 12
+3 10
+12 0
+12 1
+26 58
+58 26